@@ -58,7 +58,20 @@
 #include "axe_shortcut.h"
 #include "axe_iterator.h"
 #include "axe_exception.h"
+#include "axe_context.h"
 #include "axe_utility.h"
+#include "axe_action.h"
+#include "axe_tape.h"
+#include "axe_lexer.h"
+#include "axe_push.h"
+#include "axe_reflect.h"
+#include "axe_optimize.h"
+#include "axe_regex.h"
+#include "axe_search.h"
+#include "axe_replace.h"
+#include "axe_binary.h"
+#include "axe_json.h"
+#include "axe_csv.h"
 
 #if defined(__clang__)
 #pragma clang diagnostic pop
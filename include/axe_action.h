@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include "axe_trait.h"
+#include "axe_result.h"
+
+namespace axe
+{
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // interface of the log recording tentative work during parsing
+        // composite rules truncate the active log when an alternative fails
+        //-------------------------------------------------------------------------
+        class action_log_base
+        {
+        public:
+            virtual size_t size() const = 0;
+            virtual void truncate(size_t size) = 0;
+        protected:
+            ~action_log_base() = default;
+        };
+
+        // log receiving deferred actions in this thread, nullptr in immediate mode;
+        // constant initialized, so reading it is a plain thread local load without guard
+        inline thread_local action_log_base* active_action_log = nullptr;
+
+        //-------------------------------------------------------------------------
+        // action_mark remembers the size of active log at backtracking point
+        //-------------------------------------------------------------------------
+        class action_mark
+        {
+            action_log_base* log_;
+            size_t size_;
+        public:
+            action_mark() : log_(active_action_log), size_(log_ ? log_->size() : 0) {}
+            void rollback() const { if(log_) log_->truncate(size_); }
+        };
+
+        //-------------------------------------------------------------------------
+        // action_scope makes the log active for the lifetime of the scope
+        // only one log can be active in a thread, marks don't truncate outer logs
+        //-------------------------------------------------------------------------
+        class action_scope
+        {
+        public:
+            explicit action_scope(action_log_base& log)
+            {
+                assert(!active_action_log && "action logs can't be nested");
+                active_action_log = &log;
+            }
+
+            ~action_scope() { active_action_log = nullptr; }
+
+            action_scope(const action_scope&) = delete;
+            action_scope& operator= (const action_scope&) = delete;
+        };
+
+        //-------------------------------------------------------------------------
+        // invoke extractor with arguments it takes (same convention as r_extractor_t)
+        //-------------------------------------------------------------------------
+        template<class E, class I>
+        void invoke_extractor(const E& e, I i1, I i2, I i3)
+        {
+            static_assert(is_extractor_object_v<E>
+                || is_extractor_object_v<E, I>
+                || is_extractor_object_v<E, I, I>
+                || is_extractor_object_v<E, I, I, I>);
+
+            if constexpr(is_extractor_object_v<E>)
+                std::invoke(e);
+            else if constexpr(is_extractor_object_v<E, I>)
+                std::invoke(e, i2);
+            else if constexpr(is_extractor_object_v<E, I, I>)
+                std::invoke(e, i1, i2);
+            else if constexpr(is_extractor_object_v<E, I, I, I>)
+                std::invoke(e, i1, i2, i3);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// action_log records deferred semantic actions while parsing
+    /// actions recorded by failed alternatives are truncated at backtracking points,
+    /// committed actions are executed in the order of recording
+    /// log stores pointers to extractors, the rule must outlive commit
+    //-------------------------------------------------------------------------
+    template<class I>
+    class action_log final : public detail::action_log_base
+    {
+        struct entry
+        {
+            void (*invoke)(const void*, I, I, I);
+            const void* extractor;
+            I i1, i2, i3;
+        };
+
+        std::vector<entry> entries_;
+        size_t committed_ = 0; // number of actions executed since reset
+
+        template<class E>
+        static void invoke(const void* e, I i1, I i2, I i3)
+        {
+            detail::invoke_extractor(*static_cast<const E*>(e), i1, i2, i3);
+        }
+
+    public:
+        action_log() = default;
+        explicit action_log(size_t capacity) { entries_.reserve(capacity); }
+        action_log(const action_log&) = delete;
+        action_log& operator= (const action_log&) = delete;
+
+        size_t size() const override { return committed_ + entries_.size(); }
+
+        void truncate(size_t size) override
+        {
+            auto keep = size > committed_ ? std::min(size - committed_, entries_.size()) : 0;
+            entries_.erase(entries_.begin() + keep, entries_.end());
+        }
+
+        /// true when the log is collecting actions in this thread
+        bool active() const { return detail::active_action_log == this; }
+
+        /// number of recorded actions waiting for commit
+        size_t pending() const { return entries_.size(); }
+
+        template<class E>
+        void record(const E& e, I i1, I i2, I i3)
+        {
+            entries_.push_back(entry{ &invoke<E>, &e, i1, i2, i3 });
+        }
+
+        /// executes pending actions in order of recording
+        void commit()
+        {
+            for(size_t i = 0; i < entries_.size(); ++i)
+                entries_[i].invoke(entries_[i].extractor, entries_[i].i1, entries_[i].i2, entries_[i].i3);
+
+            committed_ += entries_.size();
+            entries_.clear();
+        }
+
+        /// discards pending actions and starts a new parse
+        void reset()
+        {
+            entries_.clear();
+            committed_ = 0;
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    /// e_deferred_t extractor records wrapped extractor in the action log,
+    /// when no log is active the extractor is called immediately,
+    /// it's an error to run it while another log is active (e.g. in parse_tape)
+    //-------------------------------------------------------------------------
+    template<class E, class I>
+    class e_deferred_t
+    {
+        action_log<I>& log_;
+        E e_;
+    public:
+        template<class EE>
+        e_deferred_t(action_log<I>& log, EE&& e) : log_(log), e_(std::forward<EE>(e)) {}
+
+        template<class Iterator>
+        void operator() (Iterator i1, Iterator i2, Iterator i3) const
+        {
+            static_assert(std::is_convertible_v<Iterator, I>, "iterator type must match action_log");
+
+            assert((log_.active() || !detail::active_action_log) && "e_deferred log is not the active log");
+
+            if(log_.active())
+                log_.record(e_, i1, i2, i3);
+            else
+                detail::invoke_extractor(e_, i1, i2, i3);
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    /// r_commit_t rule executes actions pending in the active log, always matches
+    //-------------------------------------------------------------------------
+    template<class I>
+    class r_commit_t final
+    {
+        action_log<I>& log_;
+    public:
+        explicit r_commit_t(action_log<I>& log) : log_(log) {}
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2) const
+        {
+            if(log_.active())
+                log_.commit();
+            return result(true, i1);
+        }
+
+        const char* name() const { return "r_commit"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// function e_deferred creates extractor executed when the log is committed
+    //-------------------------------------------------------------------------
+    template<class I, class E>
+    inline e_deferred_t<std::decay_t<E>, I> e_deferred(action_log<I>& log, E&& e)
+    {
+        return e_deferred_t<std::decay_t<E>, I>(log, std::forward<E>(e));
+    }
+
+    //-------------------------------------------------------------------------
+    /// function r_commit creates rule committing deferred actions
+    //-------------------------------------------------------------------------
+    template<class I>
+    inline r_commit_t<I> r_commit(action_log<I>& log)
+    {
+        return r_commit_t<I>(log);
+    }
+}
@@ -0,0 +1,617 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include "axe_trait.h"
+#include "axe_result.h"
+#include "axe_iterator.h"
+#include "axe_terminal.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace axe
+{
+    //-------------------------------------------------------------------------
+    /// leb128 is the length type of frames prefixed with unsigned LEB128 (protobuf varint)
+    //-------------------------------------------------------------------------
+    struct leb128 {};
+
+    namespace detail
+    {
+        // reads unsigned LEB128 value, fails on truncated input and values exceeding 64 bits
+        template<class I, class I2>
+        bool read_leb128(I& i1, I2 i2, uint64_t& value)
+        {
+            static_assert(sizeof(*i1) == 1, "iterator must be byte size for binary match");
+            value = 0;
+            for(unsigned shift = 0; i1 != i2 && shift < 64; shift += 7)
+            {
+                auto byte = static_cast<unsigned char>(*i1);
+                ++i1;
+                if(shift == 63 && byte > 1)
+                    return false;
+
+                value |= uint64_t(byte & 0x7f) << shift;
+                if(!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        // converts decoded varint to integer type T, fails if the value doesn't fit;
+        // signed values are either zigzag encoded or two's complement (protobuf int32/int64)
+        template<bool ZigZag, class T>
+        bool varint_value(uint64_t v, T& t)
+        {
+            if constexpr(ZigZag)
+            {
+                auto s = static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+                if(s < int64_t(std::numeric_limits<T>::min()) || s > int64_t(std::numeric_limits<T>::max()))
+                    return false;
+                t = static_cast<T>(s);
+            }
+            else if constexpr(std::is_signed_v<T>)
+            {
+                auto s = static_cast<int64_t>(v);
+                if(s < int64_t(std::numeric_limits<T>::min()) || s > int64_t(std::numeric_limits<T>::max()))
+                    return false;
+                t = static_cast<T>(s);
+            }
+            else
+            {
+                if(v > uint64_t(std::numeric_limits<T>::max()))
+                    return false;
+                t = static_cast<T>(v);
+            }
+            return true;
+        }
+
+        inline unsigned count_trailing_zeros(uint64_t x)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return unsigned(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+            unsigned long i;
+            _BitScanForward64(&i, x);
+            return unsigned(i);
+#else
+            unsigned n = 0;
+            for(; !(x & 1); x >>= 1, ++n);
+            return n;
+#endif
+        }
+
+        // loads 8 bytes in little endian order, the first byte is the lowest
+        inline uint64_t load_le64(const void* p)
+        {
+            uint64_t w;
+            std::memcpy(&w, p, sizeof(w));
+            if constexpr(!is_little_endian_v)
+            {
+                auto c = reinterpret_cast<unsigned char*>(&w);
+                std::reverse(c, c + sizeof(w));
+            }
+            return w;
+        }
+
+        // joins 7 bit groups of LEB128 bytes in w, the first byte is the lowest
+        inline uint64_t compact_leb128(uint64_t w)
+        {
+            w &= 0x7f7f7f7f7f7f7f7full;
+            w = (w & 0x007f007f007f007full) | ((w & 0x7f007f007f007f00ull) >> 1);
+            w = (w & 0x00003fff00003fffull) | ((w & 0x3fff00003fff0000ull) >> 2);
+            return (w & 0x000000000fffffffull) | ((w & 0x0fffffff00000000ull) >> 4);
+        }
+
+        // bytes of w equal to c have the high bit set
+        inline uint64_t swar_equal(uint64_t w, unsigned char c)
+        {
+            constexpr uint64_t low7 = 0x7f7f7f7f7f7f7f7full;
+            uint64_t x = w ^ (0x0101010101010101ull * c);
+            return ~(((x & low7) + low7) | x | low7);
+        }
+
+        // packs high bits of 8 bytes loaded in little endian order to 8 bit mask
+        inline uint64_t swar_movemask(uint64_t m)
+        {
+            return ((m >> 7) * 0x0102040810204080ull) >> 56;
+        }
+
+        // bit i is the parity of bits 0 to i, marks regions between pairs of quotes
+        inline uint64_t prefix_xor(uint64_t x)
+        {
+            for(unsigned shift = 1; shift < 64; shift *= 2)
+                x ^= x << shift;
+            return x;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// r_frame_t matches length prefixed frame: the length of type LenT stored in the Order
+    /// byte order (or LEB128 encoded) followed by the payload of that many bytes;
+    /// the rule R is matched in the payload range and must consume it entirely,
+    /// its extractors see the payload in place, the input is not copied;
+    /// parse tree data is the payload range;
+    /// the payload is bounded with advance_bounded, so push_parser waits for a partly arrived frame
+    //-------------------------------------------------------------------------
+    template<class LenT, byte_order Order, class R>
+    class r_frame_t final
+    {
+        static_assert(std::is_same_v<LenT, leb128> || std::is_unsigned_v<LenT>,
+            "frame length must be unsigned integer or leb128");
+        R r_;
+
+        template<class I, class I2>
+        bool read_length(I& i1, I2 i2, uint64_t& length) const
+        {
+            if constexpr(std::is_same_v<LenT, leb128>)
+                return detail::read_leb128(i1, i2, length);
+            else
+            {
+                LenT len{};
+                auto res = r_var<LenT, Order>(len)(i1, i2);
+                i1 = res.position;
+                length = len;
+                return res.matched;
+            }
+        }
+
+        template<class I, class I2>
+        auto match(I i1, I2 i2) const
+        {
+            static_assert(is_forward_iterator<I>);
+            uint64_t length = 0;
+            auto begin = i1;
+            bool matched = read_length(begin, i2, length);
+            auto end = begin;
+            matched = matched && detail::advance_bounded(end, i2, length);
+            if(matched)
+            {
+                auto res = r_(begin, end);
+                matched = res.matched && res.position == end;
+                return std::make_pair(result(matched, matched ? end : res.position), it_pair<I>(begin, end));
+            }
+            return std::make_pair(result(false, end), it_pair<I>(begin, begin));
+        }
+
+    public:
+        template<class T, class = detail::disable_copy<r_frame_t, T>>
+        explicit r_frame_t(T&& r) : r_(std::forward<T>(r)) {}
+
+        template<class I, class I2>
+        result<I> operator() (I i1, I2 i2) const
+        {
+            return match(i1, i2).first;
+        }
+
+        template<class I>
+        auto operator() (it_pair<I> itp) const
+        {
+            auto [res, payload] = match(itp.begin(), itp.end());
+            return result(payload, res.matched, res.position);
+        }
+
+        const R& rule() const { return r_; }
+        const char* name() const { return "r_frame"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// r_frame creates a rule matching length prefixed frame, e.g.
+    /// r_frame<uint16_t, byte_order::big>(header & body), r_frame<leb128>(r_rest() >> payload),
+    /// without the payload rule any payload is matched, which is O(1) for random access input
+    //-------------------------------------------------------------------------
+    template<class LenT, byte_order Order = byte_order::native, class R>
+    auto r_frame(R&& r)
+    {
+        return r_frame_t<LenT, Order, std::decay_t<R>>(std::forward<R>(r));
+    }
+
+    template<class LenT, byte_order Order = byte_order::native>
+    auto r_frame()
+    {
+        return r_frame_t<LenT, Order, r_rest>(r_rest());
+    }
+
+    //-------------------------------------------------------------------------
+    /// r_varint_t matches LEB128 encoded integer (protobuf varint) and reads its value,
+    /// zigzag encoded values are decoded if ZigZag is true (protobuf sint32/sint64),
+    /// fails without consuming the input if the value doesn't fit in T
+    /// T can be a slot of parse context
+    //-------------------------------------------------------------------------
+    template<class T, bool ZigZag>
+    class r_varint_t final
+    {
+        using value_type = detail::bound_t<T>;
+        static_assert(std::is_integral_v<value_type> && !std::is_same_v<value_type, bool>);
+        static_assert(!ZigZag || std::is_signed_v<value_type>, "zigzag encoding requires signed type");
+        detail::binding<T> t_;
+
+    public:
+        explicit r_varint_t(detail::binding<T> t) : t_(t) {}
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            static_assert(is_forward_iterator<Iterator>);
+            uint64_t v;
+            auto i = i1;
+            if(!detail::read_leb128(i, i2, v) || !detail::varint_value<ZigZag>(v, t_.get()))
+                return make_result(false, i1);
+
+            return make_result(true, i);
+        }
+
+        const char* name() const { return ZigZag ? "r_zigzag" : "r_varint"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// r_varint and r_zigzag create rules matching unsigned (or two's complement) and zigzag varints
+    //-------------------------------------------------------------------------
+    template<class T>
+    auto r_varint(T& t) { return r_varint_t<std::decay_t<T>, false>(t); }
+    template<class Ctx, class T>
+    auto r_varint(slot<Ctx, T> s) { return r_varint_t<slot<Ctx, T>, false>(s); }
+
+    template<class T>
+    auto r_zigzag(T& t) { return r_varint_t<std::decay_t<T>, true>(t); }
+    template<class Ctx, class T>
+    auto r_zigzag(slot<Ctx, T> s) { return r_varint_t<slot<Ctx, T>, true>(s); }
+
+    //-------------------------------------------------------------------------
+    /// r_varint_array_t reads a run of varints to container, the same as r_sequence:
+    /// container bound to a variable is cleared at construction,
+    /// container bound to a slot of parse context is cleared before matching;
+    /// contiguous input is decoded in 8 byte blocks masked VByte style: the ends of values
+    /// are found from continuation bits and values are extracted without per byte branching;
+    /// runs of single byte values are decoded about twice as fast as a byte loop,
+    /// multi-byte values about as fast as a byte loop (there is no SIMD shuffle)
+    //-------------------------------------------------------------------------
+    template<class C, bool ZigZag>
+    class r_varint_array_t final
+    {
+        using T = typename detail::bound_t<C>::value_type;
+        static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>);
+        static_assert(!ZigZag || std::is_signed_v<T>, "zigzag encoding requires signed type");
+        detail::binding<C> buf_;
+        const size_t min_occurrence_;
+        const size_t max_occurrence_;
+
+        static T small_value(unsigned char b)
+        {
+            if constexpr(ZigZag)
+                return static_cast<T>((b >> 1) ^ -(b & 1));
+            else
+                return static_cast<T>(b);
+        }
+
+        // decodes up to max values to out, returns the end of decoded input and the number of values
+        std::pair<const unsigned char*, size_t> decode(const unsigned char* p, const unsigned char* end,
+            T* out, size_t max) const
+        {
+            constexpr uint64_t high_bits = 0x8080808080808080ull;
+            size_t count = 0;
+            while(count < max && p != end)
+            {
+                T t;
+                if(end - p >= 8 && max - count >= 8)
+                {
+                    auto block = detail::load_le64(p);
+                    if(!(block & high_bits))
+                    {   // 8 single byte values
+                        for(int k = 0; k < 8; ++k)
+                            out[count + k] = small_value(p[k]);
+
+                        p += 8;
+                        count += 8;
+                        continue;
+                    }
+
+                    // high bits of the last bytes of values ending in the block
+                    if(auto last_bytes = ~block & high_bits)
+                    {
+                        unsigned start = 0;
+                        do
+                        {
+                            auto last = detail::count_trailing_zeros(last_bytes) / 8;
+                            last_bytes &= last_bytes - 1;
+                            auto value = detail::compact_leb128((block >> start * 8) & (~uint64_t(0) >> (7 - last + start) * 8));
+                            if(!detail::varint_value<ZigZag>(value, t))
+                                return { p + start, count };
+
+                            out[count++] = t;
+                            start = last + 1;
+                        } while(last_bytes);
+
+                        p += start;
+                        continue;
+                    }
+                }
+
+                // values longer than 8 bytes and the tail of input
+                auto i = p;
+                uint64_t v;
+                if(!detail::read_leb128(i, end, v) || !detail::varint_value<ZigZag>(v, t))
+                    break;
+
+                out[count++] = t;
+                p = i;
+            }
+            return { p, count };
+        }
+
+        // decodes in chunks on stack and appends them, resizing the container to decode
+        // in place is slower because resize initializes the values
+        template<class Buf>
+        const unsigned char* decode(Buf& buf, const unsigned char* p, const unsigned char* end) const
+        {
+            std::array<T, 256> chunk;
+            for(size_t left = max_occurrence_; left > 0 && p != end;)
+            {
+                auto n = std::min(left, chunk.size());
+                auto [last, count] = decode(p, end, chunk.data(), n);
+                buf.insert(buf.end(), chunk.begin(), chunk.begin() + count);
+                p = last;
+                left -= count;
+                if(count < n)
+                    break;
+            }
+            return p;
+        }
+
+    public:
+        r_varint_array_t(detail::binding<C> buf, size_t min_occurrence, size_t max_occurrence)
+            : buf_(buf), min_occurrence_(min_occurrence), max_occurrence_(max_occurrence)
+        {
+            if constexpr(!is_slot_v<C>)
+                buf_.get().clear();
+        }
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            static_assert(is_forward_iterator<Iterator>);
+            auto& buf = buf_.get();
+            if constexpr(is_slot_v<C>)
+                buf.clear();
+
+            if constexpr(detail::is_contiguous_bytes_v<Iterator, Iterator2>)
+            {
+                if(i1 != i2)
+                {
+                    auto p = reinterpret_cast<const unsigned char*>(std::addressof(*i1));
+                    i1 += decode(buf, p, p + (i2 - i1)) - p;
+                }
+            }
+            else
+            {
+                for(size_t s = 0; i1 != i2 && s < max_occurrence_; ++s)
+                {
+                    T t;
+                    auto&& r = r_varint_t<T, ZigZag>(t)(i1, i2);
+                    if(!r.matched)
+                        break;
+
+                    i1 = r.position;
+                    buf.push_back(t);
+                }
+            }
+
+            return make_result(buf.size() >= min_occurrence_, i1);
+        }
+
+        const char* name() const { return ZigZag ? "r_zigzag_array" : "r_varint_array"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// r_varint_array and r_zigzag_array create rules reading runs of varints to container
+    //-------------------------------------------------------------------------
+    template<class C>
+    auto r_varint_array(C& c, size_t min_occurrence = 0, size_t max_occurrence = -1)
+    {
+        return r_varint_array_t<std::decay_t<C>, false>(c, min_occurrence, max_occurrence);
+    }
+    template<class Ctx, class C>
+    auto r_varint_array(slot<Ctx, C> s, size_t min_occurrence = 0, size_t max_occurrence = -1)
+    {
+        return r_varint_array_t<slot<Ctx, C>, false>(s, min_occurrence, max_occurrence);
+    }
+
+    template<class C>
+    auto r_zigzag_array(C& c, size_t min_occurrence = 0, size_t max_occurrence = -1)
+    {
+        return r_varint_array_t<std::decay_t<C>, true>(c, min_occurrence, max_occurrence);
+    }
+    template<class Ctx, class C>
+    auto r_zigzag_array(slot<Ctx, C> s, size_t min_occurrence = 0, size_t max_occurrence = -1)
+    {
+        return r_varint_array_t<slot<Ctx, C>, true>(s, min_occurrence, max_occurrence);
+    }
+
+    namespace detail
+    {
+        template<class I>
+        constexpr bool is_bit_iterator_v = false;
+
+        template<class I, bit_order Order>
+        constexpr bool is_bit_iterator_v<bit_iterator<I, Order>> = true;
+
+        constexpr uint64_t low_bits(unsigned n) { return n < 64 ? (uint64_t(1) << n) - 1 : ~uint64_t(0); }
+
+        // reads field of n (1 to 64) bits, the first bit read is the most significant bit
+        // of the field in msb_first order and the least significant in lsb_first order;
+        // contiguous input is loaded 64 bit word at a time, other input a byte at a time
+        template<class I, bit_order Order>
+        bool read_bits(bit_iterator<I, Order>& i1, bit_iterator<I, Order> i2, unsigned n, uint64_t& value)
+        {
+            auto it = i1.get();
+            unsigned bit = i1.bit();
+            if constexpr(is_contiguous_bytes_v<I, I>)
+            {
+                if(i2.get() - it >= 8 && bit + n <= 64)
+                {
+                    auto p = reinterpret_cast<const unsigned char*>(std::addressof(*it));
+                    uint64_t word = 0;
+                    if constexpr(Order == bit_order::msb_first)
+                    {
+                        for(int k = 0; k < 8; ++k)
+                            word = word << 8 | p[k];
+
+                        value = (word << bit) >> (64 - n);
+                    }
+                    else
+                    {
+                        for(int k = 8; k-- > 0;)
+                            word = word << 8 | p[k];
+
+                        value = (word >> bit) & low_bits(n);
+                    }
+
+                    bit += n;
+                    i1 = bit_iterator<I, Order>(it + bit / 8, bit % 8);
+                    return true;
+                }
+            }
+
+            value = 0;
+            for(unsigned shift = 0; n > 0;)
+            {
+                unsigned avail = it != i2.get() ? 8 - bit : i2.bit() > bit ? i2.bit() - bit : 0;
+                if(avail == 0)
+                    return false;
+
+                unsigned take = std::min(avail, n);
+                auto byte = static_cast<unsigned char>(*it);
+                if constexpr(Order == bit_order::msb_first)
+                    value = value << take | ((byte >> (8 - bit - take)) & low_bits(take));
+                else
+                {
+                    value |= ((byte >> bit) & low_bits(take)) << shift;
+                    shift += take;
+                }
+
+                n -= take;
+                if((bit += take) == 8)
+                {
+                    bit = 0;
+                    ++it;
+                }
+            }
+
+            i1 = bit_iterator<I, Order>(it, bit);
+            return true;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// r_bits_t matches bit field of N bits in bit_iterator input and reads its value,
+    /// bits are ordered according to the bit_iterator order, the value isn't sign extended
+    /// T can be a slot of parse context
+    //-------------------------------------------------------------------------
+    template<class T, unsigned N>
+    class r_bits_t final
+    {
+        using value_type = detail::bound_t<T>;
+        static_assert(std::is_integral_v<value_type> || std::is_enum_v<value_type>);
+        static_assert(N > 0 && N <= 64 && (N <= 8 * sizeof(value_type) || std::is_same_v<value_type, bool>),
+            "bit field doesn't fit in value type");
+        detail::binding<T> t_;
+
+    public:
+        explicit r_bits_t(detail::binding<T> t) : t_(t) {}
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            static_assert(detail::is_bit_iterator_v<Iterator> && std::is_same_v<Iterator, Iterator2>,
+                "r_bits requires bit_iterator input");
+            uint64_t v;
+            auto i = i1;
+            if(!detail::read_bits(i, i2, N, v))
+                return make_result(false, i1);
+
+            t_.get() = static_cast<value_type>(v);
+            return make_result(true, i);
+        }
+
+        const char* name() const { return "r_bits"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// r_bits creates a rule reading N bit field, e.g.
+    /// parse(r_bits<3>(version) & r_bits<13>(length), bit_range(header))
+    //-------------------------------------------------------------------------
+    template<unsigned N, class T>
+    auto r_bits(T& t) { return r_bits_t<std::decay_t<T>, N>(t); }
+    template<unsigned N, class Ctx, class T>
+    auto r_bits(slot<Ctx, T> s) { return r_bits_t<slot<Ctx, T>, N>(s); }
+
+    //-------------------------------------------------------------------------
+    /// r_bit_pattern_t matches N bits equal to pattern, bits are ordered the same as in r_bits
+    //-------------------------------------------------------------------------
+    template<unsigned N>
+    class r_bit_pattern_t final
+    {
+        static_assert(N > 0 && N <= 64);
+        uint64_t pattern_;
+
+    public:
+        explicit r_bit_pattern_t(uint64_t pattern) : pattern_(pattern)
+        {
+            assert(pattern == (pattern & detail::low_bits(N)));
+        }
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            static_assert(detail::is_bit_iterator_v<Iterator> && std::is_same_v<Iterator, Iterator2>,
+                "r_bit_pattern requires bit_iterator input");
+            uint64_t v;
+            auto i = i1;
+            if(!detail::read_bits(i, i2, N, v) || v != pattern_)
+                return make_result(false, i1);
+
+            return make_result(true, i);
+        }
+
+        const char* name() const { return "r_bit_pattern"; }
+    };
+
+    template<unsigned N>
+    auto r_bit_pattern(uint64_t pattern) { return r_bit_pattern_t<N>(pattern); }
+}
@@ -29,17 +29,20 @@
 #pragma once
 
 #include <utility>
+#include <algorithm>
 #include <functional>
 #include <stddef.h>
 #include <typeinfo>
 #include <tuple>
 #include <variant>
 #include <optional>
+#include <memory>
 #include "axe_result.h"
 #include "axe_trait.h"
 #include "axe_iterator.h"
 #include "axe_exception.h"
 #include "axe_detail.h"
+#include "axe_action.h"
 
 namespace axe
 {
@@ -57,7 +60,7 @@ namespace axe
                 : rs_(std::forward<T1>(r1), std::forward<T2>(r2), std::forward<Ts>(rs)...)
             {}
 
-            decltype(auto) get() const & { return rs_; }
+            decltype(auto) get() const & { return (rs_); }
             decltype(auto) get() && { return std::move(rs_); }
         };
 
@@ -76,6 +79,24 @@ namespace axe
             }
         }
         
+        // runs the rule over const pointers to contiguous input and maps the position back to I,
+        // all contiguous iterators of the same value type share one instantiation of the rule
+        template<class R, class I>
+        result<I> invoke_contiguous(const R& r, I i1, I i2)
+        {
+            static_assert(is_contiguous_iterator<I>);
+            using value_t = typename std::iterator_traits<I>::value_type;
+            auto size = i2 - i1;
+            const value_t* p = size ? std::addressof(*i1) : nullptr;
+            auto res = r(p, p + size);
+            return result(res.matched, i1 + (res.position - p));
+        }
+
+        // true for contiguous iterators other than const pointers
+        template<class I, class I2>
+        constexpr bool is_pointer_convertible_v = std::is_same_v<I, I2> && is_contiguous_iterator<I>
+            && !std::is_same_v<I, const typename std::iterator_traits<I>::value_type*>;
+
         // result type of parse_tree invocation
         template<class R, class I>
         using parse_tree_result_t = decltype(parse_tree_invoke(std::declval<R>(), it_pair<I>{}));
@@ -182,11 +203,13 @@ namespace axe
         template<class Iterator, class Iterator2, class Rule, class...Rules>
         static auto match(Iterator i1, Iterator2 i2, Rule&& r, Rules&&... rs)
         {
+            detail::action_mark mark;
             auto res = std::invoke(std::forward<Rule>(r), i1, i2);
             if constexpr (sizeof...(Rules) != 0)
             {
                 if (!res.matched)
                 {
+                    mark.rollback();
                     auto pos = res.position;
                     res = match(i1, i2, std::forward<Rules>(rs)...);
                     if (!res.matched && std::distance(i1, pos) > std::distance(i1, res.position))
@@ -201,6 +224,7 @@ namespace axe
             result<Iterator, std::variant<detail::parse_tree_data_t<Rule, Iterator>, detail::parse_tree_data_t<Rules, Iterator>...>>
         {
             using data_t = std::variant<detail::parse_tree_data_t<Rule, Iterator>, detail::parse_tree_data_t<Rules, Iterator>...>;
+            detail::action_mark mark;
             auto res = detail::parse_tree_invoke(std::forward<Rule>(r), itp);
             
             result<Iterator, data_t> rslt(
@@ -212,6 +236,7 @@ namespace axe
             {
                 if (!res.matched)
                 {
+                    mark.rollback();
                     auto res1 = match_tree(itp, std::forward<Rules>(rs)...);
                     if (res1.matched)
                     {
@@ -267,18 +292,26 @@ namespace axe
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
         {
+            detail::action_mark mark;
             auto&& rslt = r1_(i1, i2);
             if(rslt.matched)
             {
+                mark = detail::action_mark();
                 auto&& rslt2 = r2_(rslt.position, i2);
+                if(!rslt2.matched)
+                    mark.rollback();
                 return make_result(true, rslt2.matched ? rslt2.position : rslt.position);
             }
             else
             {
+                mark.rollback();
                 rslt = r2_(i1, i2);
                 if(rslt.matched)
                 {
+                    mark = detail::action_mark();
                     auto&& rslt2 = r1_(rslt.position, i2);
+                    if(!rslt2.matched)
+                        mark.rollback();
                     return make_result(true, rslt2.matched ? rslt2.position : rslt.position);
                 }
             }
@@ -302,9 +335,13 @@ namespace axe
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
         {
+            detail::action_mark mark;
             auto&& i = r_(i1, i2);
+            mark.rollback(); // negation doesn't perform actions
             return make_result(!i.matched, i1, i.position);
         }
+
+        const R& rule() const { return r_; }
     };
 
     //-----------------------------------------------------------------------------
@@ -326,11 +363,33 @@ namespace axe
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
         {
+            detail::action_mark mark;
             auto&& match = r1_(i1, i2);
-            return match.matched ? r2_(match.position, i2) : r3_(i1, i2);
+            if(match.matched)
+                return r2_(match.position, i2);
+            mark.rollback();
+            return r3_(i1, i2);
         }
     };
 
+    struct r_empty;
+
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // single_element_rule is true for rules which match exactly one element or fail,
+        // specializations define test(rule, element) and flag any for rules matching every element
+        //-------------------------------------------------------------------------
+        template<class R, class = void>
+        struct single_element_rule : std::false_type {};
+
+        template<class R>
+        using single_element_rule_t = single_element_rule<std::remove_cv_t<std::remove_reference_t<R>>>;
+
+        template<class R>
+        constexpr bool is_single_element_rule_v = single_element_rule_t<R>::value;
+    }
+
     //-----------------------------------------------------------------------------
     /// class r_many_t defines a sequence of rules separated by separator rule
     //-----------------------------------------------------------------------------
@@ -342,6 +401,28 @@ namespace axe
         const size_t min_occurrence_;
         const size_t max_occurrence_;
 
+        // single element rules without separator are matched by counted scan,
+        // the first element is always tried, so at least one element is allowed
+        template<class Iterator, class Iterator2>
+        result<Iterator> match_elements(Iterator i1, Iterator2 i2) const
+        {
+            using rule_t = detail::single_element_rule_t<R>;
+            auto max_occurrence = std::max<size_t>(max_occurrence_, 1);
+            size_t count = 0;
+
+            if constexpr(rule_t::any && is_random_access_iterator<Iterator> && std::is_same_v<Iterator, Iterator2>)
+            {
+                count = std::min<size_t>(max_occurrence, std::distance(i1, i2));
+                std::advance(i1, count);
+            }
+            else
+            {
+                for(; count < max_occurrence && i1 != i2 && rule_t::test(r_, *i1); ++i1, ++count);
+            }
+
+            return make_result(count >= min_occurrence_, i1);
+        }
+
     public:
         template<class TR, class TS>
         r_many_t(TR&& r, TS&& separator, size_t min_occurrence, size_t max_occurrence)
@@ -353,16 +434,24 @@ namespace axe
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2)  const
         {
+            if constexpr(std::is_same_v<S, r_empty> && detail::is_single_element_rule_v<R>)
+                return match_elements(i1, i2);
+
+            detail::action_mark mark;
             auto i_match = r_(i1, i2);
 
             if(!i_match.matched)
+            {
+                mark.rollback();
                 return make_result(!min_occurrence_, i1, i_match.position);
+            }
 
             size_t count = 1;
             auto match = i_match;
 
             while(match.matched && count < max_occurrence_)
             {
+                mark = detail::action_mark();
                 match = separator_(match.position, i2);
                 if(match.matched)
                     match = r_(match.position, i2);
@@ -371,6 +460,8 @@ namespace axe
                     i_match = match;
                     ++count;
                 }
+                else
+                    mark.rollback();
             }
 
             return make_result(count >= min_occurrence_, i_match.position, match.position);
@@ -389,18 +480,23 @@ namespace axe
             auto i = itp.begin();
             auto last_pos = i;
 
+            detail::action_mark mark;
+
             while (rule_match && sep_match && count < max_occurrence_)
             {
                 auto rule_res = detail::parse_tree_invoke(r_, it_pair(i, itp.end()));
                 rule_match = rule_res.matched;
                 last_pos = rule_res.position;
 
-                if (rule_match)
+                if (!rule_match)
+                    mark.rollback(); // discard actions of the separator and failed rule
+                else
                 {
                     ++count;
                     data.push_back(std::move(rule_res.data));
 
                     // separators don't extract data
+                    mark = detail::action_mark();
                     auto sep_res = std::invoke(separator_, rule_res.position, itp.end());
                     sep_match = sep_res.matched;
                     if(sep_match)
@@ -413,6 +509,11 @@ namespace axe
             auto matched = count >= min_occurrence_;
             return result(std::move(data), matched, matched ? i : last_pos);
         }
+
+        const R& rule() const { return r_; }
+        const S& separator() const { return separator_; }
+        size_t min_occurrence() const { return min_occurrence_; }
+        size_t max_occurrence() const { return max_occurrence_; }
     };
 
     //-----------------------------------------------------------------------------
@@ -429,7 +530,10 @@ namespace axe
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2)  const
         {
+            detail::action_mark mark;
             auto&& i = r_(i1, i2);
+            if(!i.matched)
+                mark.rollback();
             return make_result(true, i.matched ? i.position : i1);
         }
 
@@ -438,13 +542,17 @@ namespace axe
             ->result<Iterator, std::optional < detail::parse_tree_data_t<R, Iterator>>>
         {
             using data_t = detail::parse_tree_data_t<R, Iterator>;
+            detail::action_mark mark;
             auto rule_res = detail::parse_tree_invoke(r_, itp);
             if(rule_res.matched)
                 return result(std::optional<data_t>{rule_res.data},
                 true, rule_res.position);
-            else
-                return result(std::optional<data_t>{}, true, itp.begin());
+
+            mark.rollback();
+            return result(std::optional<data_t>{}, true, itp.begin());
         }
+
+        const R& rule() const { return r_; }
     };
 
     //-----------------------------------------------------------------------------
@@ -478,28 +586,34 @@ namespace axe
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2)  const
         {
-            auto&& match = make_result(false, i1);
-
-            for(; i1 != i2 && !match.matched; ++i1)
+            // the end of range is also tried, rules like r_end can only match there
+            for(;; ++i1)
             {
-                match = r_(i1, i2);
+                detail::action_mark mark;
+                auto match = r_(i1, i2);
+                if(match.matched || i1 == i2)
+                    return match;
+                mark.rollback();
             }
-
-            return match;
         }
         
         template<class Iterator>
         auto operator() (it_pair<Iterator> itp)  const -> detail::parse_tree_result_t<R, Iterator>
         {
+            detail::action_mark mark;
             auto res = detail::parse_tree_invoke(r_, itp);
 
-            for (; !itp.empty() && !res.matched; itp.next())
+            while(!res.matched && !itp.empty())
             {
+                mark.rollback();
+                itp.next();
                 res = detail::parse_tree_invoke(r_, itp);
             }
 
             return res;
         }
+
+        const R& rule() const { return r_; }
     };
 
     //-----------------------------------------------------------------------------
@@ -584,22 +698,25 @@ namespace axe
         {
             return make_result(r_(i1, i2).matched, i1);
         }
+
+        const R& rule() const { return r_; }
     };
 
     //-----------------------------------------------------------------------------
     /// r_rule is a polymorphic rule, used primarily for defining recursive rules
+    /// S is the type of the end of input, e.g. null_sentinel for C strings
     //-----------------------------------------------------------------------------
-    template<class I>
+    template<class I, class S = I>
     class r_rule final
     {
-        std::function<result<I>(I, I)> fun_;
+        std::function<result<I>(I, S)> fun_;
     public:
         r_rule() = default;
 
-        template<class Fun, class = detail::disable_copy<r_rule<I>, Fun>>
+        template<class Fun, class = detail::disable_copy<r_rule<I, S>, Fun>>
         r_rule(Fun&& fun) : fun_(std::forward<Fun>(fun)) {}
 
-        template<class Fun, class = detail::disable_copy<r_rule<I>, Fun>>
+        template<class Fun, class = detail::disable_copy<r_rule<I, S>, Fun>>
         r_rule& operator= (Fun&& fun) { fun_ = std::forward<Fun>(fun); return *this; }
 
         explicit operator bool() const { return (bool)fun_; }
@@ -608,6 +725,7 @@ namespace axe
         result<Iterator> operator()(Iterator i1, Iterator2 i2) const
         {
             static_assert(std::is_convertible<Iterator, I>::value);
+            static_assert(std::is_convertible<Iterator2, S>::value);
             if (fun_)
                 return fun_(i1, i2);
             else // always match an empty rule
@@ -627,9 +745,10 @@ namespace axe
         template<class T1, class T2>
         r_unordered_and_t(T1&& r1, T2&& r2) : r1_(std::forward<T1>(r1)), r2_(std::forward<T2>(r2)) {}
 
-        template<class Iterator>
-        result<Iterator> operator()(Iterator i1, Iterator i2) const
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator()(Iterator i1, Iterator2 i2) const
         {
+            detail::action_mark mark;
             auto match = r1_(i1, i2);
 			if (match.matched)
 			{
@@ -637,6 +756,7 @@ namespace axe
 			}
 			else
             {
+                mark.rollback();
                 match = r2_(i1, i2);
                 if(match.matched)
                     match = r1_(match.position, i2);
@@ -657,15 +777,20 @@ namespace axe
         template<class T1, class T2>
         r_seq_or_t(T1&& r1, T2&& r2) : r1_(std::forward<T1>(r1)), r2_(std::forward<T2>(r2)) {}
 
-        template<class Iterator>
-        result<Iterator> operator()(Iterator i1, Iterator i2) const
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator()(Iterator i1, Iterator2 i2) const
         {
+            detail::action_mark mark;
             auto match = r1_(i1, i2);
             if(match.matched)
             {
+                mark = detail::action_mark();
                 auto match1 = r2_(match.position, i2);
+                if(!match1.matched)
+                    mark.rollback();
                 return make_result(true, match1.matched ? match1.position : match.position);
             }
+            mark.rollback();
             return r2_(i1, i2);
         }
     };
@@ -682,8 +807,8 @@ namespace axe
         template<class T1, class T2>
         r_atomic_t(T1&& r1, T2&& r2) : r1_(std::forward<T1>(r1)), r2_(std::forward<T2>(r2)) {}
 
-        template<class Iterator>
-        result<Iterator> operator()(Iterator i1, Iterator i2) const
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator()(Iterator i1, Iterator2 i2) const
         {
             auto match = r1_(i1, i2);
             if(match.matched)
@@ -702,10 +827,13 @@ namespace axe
 
     //-----------------------------------------------------------------------------
     // skip rule
+    // cached variant remembers positions skipped by rule skipper in random access range,
+    // which makes skipping after backtracking O(1)
     //-----------------------------------------------------------------------------
-    template<class R, class F>
+    template<class R, class F, bool Cached = false>
     class r_skip_t final
     {
+        static_assert(!Cached || AXE_IS_RULE(F), "predicate skippers are cheaper to re-run than to cache");
         R r_;
         F f_;
     public:
@@ -715,8 +843,18 @@ namespace axe
         template<class I, class I2>
         result<I> operator() (I i1, I2 i2) const
         {
-            auto rslt = r_(skip_iterator(i1, i2, f_), skip_iterator(i2, i2, f_));
-            return result(rslt.matched, rslt.position.get());
+            if constexpr(Cached && is_random_access_iterator<I> && std::is_same_v<I, I2>)
+            {
+                skip_cache<I, F> cache(i1, i2, f_);
+                auto rslt = r_(cached_skip_iterator(cache, i1), cached_skip_iterator(cache, i2));
+                return result(rslt.matched, rslt.position.get());
+            }
+            else
+            {   // skip_iterator needs the end iterator to stop skipping
+                auto end = find_end(i1, i2);
+                auto rslt = r_(skip_iterator(i1, end, f_), skip_iterator(end, end, f_));
+                return result(rslt.matched, rslt.position.get());
+            }
         }
     };
 
@@ -732,13 +870,21 @@ namespace axe
         template<class TR, class TF>
         r_convert_t(TR&& r, TF&& f) : r_(std::forward<TR>(r)), f_(std::forward<TF>(f)) {}
 
-        template<class I>
-        result<I> operator() (I i1, I i2) const
+        template<class I, class I2>
+        result<I> operator() (I i1, I2 i2) const
         {
             convert_iterator<I, F> begin(i1, f_);
-            convert_iterator<I, F> end(i2, f_);
-            auto rslt = r_(begin, end);
-            return axe::make_result(rslt.matched, rslt.position.get());
+            if constexpr(std::is_same_v<I, I2>)
+            {
+                convert_iterator<I, F> end(i2, f_);
+                auto rslt = r_(begin, end);
+                return axe::make_result(rslt.matched, rslt.position.get());
+            }
+            else
+            {
+                auto rslt = r_(begin, convert_sentinel<I2>{ i2 });
+                return axe::make_result(rslt.matched, rslt.position.get());
+            }
         }
     };
 
@@ -753,10 +899,10 @@ namespace axe
         template<class T, class = detail::disable_copy<r_buffered_t<R>, T>>
         r_buffered_t(T&& r) : r_(std::forward<T>(r)) {}
 
-        template<class I>
-        result<I> operator() (I i1, I i2) const
+        template<class I, class I2>
+        result<I> operator() (I i1, I2 i2) const
         {
-            input_buffer<I> buf(i1, i2);
+            input_buffer<I, std::vector, std::allocator<typename std::iterator_traits<I>::value_type>, I2> buf(i1, i2);
             auto begin = buf.begin();
             auto end = buf.end();
             auto rslt = r_(begin, end);
@@ -773,6 +919,30 @@ namespace axe
         }
     };
 
+    //-----------------------------------------------------------------------------
+    // contiguous rule runs the rule over const pointers if the input is contiguous,
+    // semantic actions of the rule receive pointers instead of the caller's iterators
+    //-----------------------------------------------------------------------------
+    template<class R>
+    class r_contiguous_t final
+    {
+        R r_;
+    public:
+        template<class T, class = detail::disable_copy<r_contiguous_t<R>, T>>
+        r_contiguous_t(T&& r) : r_(std::forward<T>(r)) {}
+
+        template<class I, class I2>
+        result<I> operator() (I i1, I2 i2) const
+        {
+            if constexpr(detail::is_pointer_convertible_v<I, I2>)
+                return detail::invoke_contiguous(r_, i1, i2);
+            else
+                return r_(i1, i2);
+        }
+
+        const R& rule() const { return r_; }
+    };
+
     //-----------------------------------------------------------------------------
     // named rule
     //-----------------------------------------------------------------------------
@@ -785,12 +955,72 @@ namespace axe
         template<class T>
         r_named_t(T&& r, const char* name) : r_(std::forward<T>(r)), name_(name) {}
 
-        template<class I>
-        result<I> operator() (I i1, I i2) const { return r_(i1, i2); }
+        template<class I, class I2>
+        result<I> operator() (I i1, I2 i2) const { return r_(i1, i2); }
 
+        const R& rule() const { return r_; }
         const char* name() const { return name_; }
     };
 
+    namespace detail
+    {
+        template<class... Rs>
+        struct single_element_rule<r_or_t<Rs...>, std::enable_if_t<(is_single_element_rule_v<Rs> && ...)>> : std::true_type
+        {
+            static constexpr bool any = (single_element_rule_t<Rs>::any || ...);
+
+            template<class V>
+            static bool test(const r_or_t<Rs...>& r, const V& v)
+            {
+                return std::apply([&](const auto&... rs) { return (single_element_rule_t<decltype(rs)>::test(rs, v) || ...); }, r.get());
+            }
+        };
+
+        // difference r - r1 - r2 ..., which is flattened to !rn & ... & !r1 & r
+        template<class R>
+        constexpr bool is_single_element_negation_v = false;
+
+        template<class R>
+        constexpr bool is_single_element_negation_v<r_not_t<R>> = is_single_element_rule_v<R>;
+
+        template<class Rs, class = std::make_index_sequence<std::tuple_size_v<Rs> - 1>>
+        struct single_element_difference;
+
+        template<class... Rs, size_t... I>
+        struct single_element_difference<std::tuple<Rs...>, std::index_sequence<I...>>
+        {
+            using last_t = std::tuple_element_t<sizeof...(I), std::tuple<Rs...>>;
+            static constexpr bool value = is_single_element_rule_v<last_t>
+                && (is_single_element_negation_v<std::tuple_element_t<I, std::tuple<Rs...>>> && ...);
+
+            template<class V>
+            static bool test(const std::tuple<Rs...>& rs, const V& v)
+            {
+                return (!single_element_rule_t<decltype(std::get<I>(rs).rule())>::test(std::get<I>(rs).rule(), v) && ...)
+                    && single_element_rule_t<last_t>::test(std::get<sizeof...(I)>(rs), v);
+            }
+        };
+
+        template<class... Rs>
+        struct single_element_rule<r_and_t<Rs...>, std::enable_if_t<single_element_difference<std::tuple<Rs...>>::value>>
+            : std::true_type
+        {
+            static constexpr bool any = false;
+
+            template<class V>
+            static bool test(const r_and_t<Rs...>& r, const V& v) { return single_element_difference<std::tuple<Rs...>>::test(r.get(), v); }
+        };
+
+        template<class R>
+        struct single_element_rule<r_named_t<R>, std::enable_if_t<is_single_element_rule_v<R>>> : std::true_type
+        {
+            static constexpr bool any = single_element_rule_t<R>::any;
+
+            template<class V>
+            static bool test(const r_named_t<R>& r, const V& v) { return single_element_rule_t<R>::test(r.rule(), v); }
+        };
+    }
+
 	//-----------------------------------------------------------------------------
 	// constrained rule
 	// after matching the rule constraint is checked
@@ -165,6 +165,18 @@ namespace axe
             axe::is_any_t<const charT*>(str));
     }
 
+    //-------------------------------------------------------------------------
+    // r_skip_cached creates skip rule caching positions skipped by rule f in random access range,
+    // other ranges are skipped without cache; predicate skippers are cheaper to re-run, use r_skip
+    //-------------------------------------------------------------------------
+    template<class R, class F>
+    inline
+        std::enable_if_t< AXE_IS_RULE(R) && AXE_IS_RULE(F), r_skip_t<std::decay_t<R>, std::decay_t<F>, true> >
+        r_skip_cached(R&& r, F&& f)
+    {
+        return r_skip_t<std::decay_t<R>, std::decay_t<F>, true>(std::forward<R>(r), std::forward<F>(f));
+    }
+
     //-------------------------------------------------------------------------
     // r_convert creates a new rule that converts iterator according to function
     //-------------------------------------------------------------------------
@@ -257,6 +269,17 @@ namespace axe
         return r_buffered_t<std::decay_t<R>>(std::forward<R>(r));
     }
 
+    //-------------------------------------------------------------------------
+    // r_contiguous creates a rule running over const pointers for contiguous input,
+    // all semantic actions of the rule must accept pointers
+    //-------------------------------------------------------------------------
+    template<class R>
+    inline
+        r_contiguous_t<detail::enable_if_rule<R>> r_contiguous(R&& r)
+    {
+        return r_contiguous_t<std::decay_t<R>>(std::forward<R>(r));
+    }
+
     //-------------------------------------------------------------------------
     // r_named creates a named rule with the same semantics
     //-------------------------------------------------------------------------
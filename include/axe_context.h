@@ -0,0 +1,128 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include "axe_exception.h"
+
+namespace axe
+{
+    namespace detail
+    {
+        // context of the parse running in this thread, set by parse(r, txt, ctx)
+        template<class Ctx>
+        inline thread_local Ctx* current_context = nullptr;
+
+        //-------------------------------------------------------------------------
+        // context_scope makes the context current for the lifetime of the scope
+        //-------------------------------------------------------------------------
+        template<class Ctx>
+        class context_scope
+        {
+            Ctx* saved_;
+        public:
+            explicit context_scope(Ctx& ctx) : saved_(current_context<Ctx>) { current_context<Ctx> = &ctx; }
+            ~context_scope() { current_context<Ctx> = saved_; }
+            context_scope(const context_scope&) = delete;
+            context_scope& operator= (const context_scope&) = delete;
+        };
+    }
+
+    //-------------------------------------------------------------------------
+    /// context returns parse context of type Ctx passed to parse function in this thread,
+    /// throws failure if the rule is parsed without context
+    //-------------------------------------------------------------------------
+    template<class Ctx>
+    Ctx& context()
+    {
+        if(!detail::current_context<Ctx>)
+            throw_failure("parse context is not set");
+        return *detail::current_context<Ctx>;
+    }
+
+    //-------------------------------------------------------------------------
+    /// slot refers to a member of parse context, it's used instead of variable reference
+    /// to make rules reentrant: the same grammar object can be used by several threads,
+    /// each passing its own context to parse function
+    //-------------------------------------------------------------------------
+    template<class Ctx, class T>
+    class slot
+    {
+        T Ctx::* member_;
+    public:
+        using context_type = Ctx;
+        using value_type = T;
+
+        constexpr slot(T Ctx::* member) : member_(member) {}
+
+        T& get() const { return context<Ctx>().*member_; }
+    };
+
+    template<class Ctx, class T>
+    slot(T Ctx::*)->slot<Ctx, T>;
+
+    template<class T>
+    struct is_slot : std::false_type {};
+
+    template<class Ctx, class T>
+    struct is_slot<slot<Ctx, T>> : std::true_type {};
+
+    template<class T>
+    constexpr bool is_slot_v = is_slot<std::remove_cv_t<T>>::value;
+
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // binding holds extraction target of a rule: variable reference or context slot
+        //-------------------------------------------------------------------------
+        template<class T>
+        class binding
+        {
+            T& t_;
+        public:
+            binding(T& t) : t_(t) {}
+            T& get() const { return t_; }
+        };
+
+        template<class Ctx, class T>
+        class binding<slot<Ctx, T>>
+        {
+            slot<Ctx, T> slot_;
+        public:
+            binding(const slot<Ctx, T>& s) : slot_(s) {}
+            T& get() const { return slot_.get(); }
+        };
+
+        // type of the bound value
+        template<class T>
+        using bound_t = std::remove_reference_t<decltype(std::declval<binding<T>>().get())>;
+    }
+}
@@ -0,0 +1,481 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <bitset>
+#include <future>
+#include <thread>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include "axe_trait.h"
+#include "axe_result.h"
+#include "axe_iterator.h"
+#include "axe_binary.h"
+
+namespace axe
+{
+    //-------------------------------------------------------------------------
+    /// csv_format specifies field delimiter and quote character,
+    /// records are separated by "\n" or "\r\n"
+    //-------------------------------------------------------------------------
+    struct csv_format
+    {
+        char delimiter = ',';
+        char quote = '"';
+    };
+
+    constexpr csv_format tsv_format{ '\t', '"' };
+
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // csv_scanner finds delimiters and newlines outside of quotes in 64 byte blocks,
+        // quoted regions are found by prefix xor of quote bitmap, doubled quotes
+        // close and reopen the region
+        //-------------------------------------------------------------------------
+        class csv_scanner
+        {
+            const char* block_;
+            const char* end_;
+            csv_format fmt_;
+            uint64_t separators_ = 0; // unvisited separators of the current block
+            uint64_t in_quote_ = 0; // all ones when the current block ends inside quotes
+
+            void load()
+            {
+                char buf[64];
+                auto p = block_;
+                if(end_ - block_ < 64)
+                {
+                    char pad = ' '; // neither quote, delimiter, nor newline
+                    for(; pad == fmt_.quote || pad == fmt_.delimiter; ++pad);
+                    std::memset(buf, pad, sizeof(buf));
+                    std::memcpy(buf, block_, end_ - block_);
+                    p = buf;
+                }
+
+                uint64_t quote = 0, separator = 0;
+                for(unsigned k = 0; k < 8; ++k)
+                {
+                    uint64_t w = load_le64(p + k * 8);
+                    quote |= swar_movemask(swar_equal(w, fmt_.quote)) << (k * 8);
+                    separator |= swar_movemask(swar_equal(w, fmt_.delimiter) | swar_equal(w, '\n')) << (k * 8);
+                }
+
+                uint64_t quoted = prefix_xor(quote) ^ in_quote_;
+                in_quote_ = 0 - (quoted >> 63);
+                separators_ = separator & ~quoted;
+            }
+
+        public:
+            csv_scanner(const char* begin, const char* end, csv_format fmt, bool in_quote = false)
+                : block_(begin), end_(end), fmt_(fmt), in_quote_(in_quote ? ~uint64_t(0) : 0)
+            {
+                if(begin != end)
+                    load();
+            }
+
+            // returns the next delimiter or newline outside of quotes, nullptr at the end of input
+            const char* next()
+            {
+                while(!separators_)
+                {
+                    if(end_ - block_ <= 64)
+                        return nullptr;
+
+                    block_ += 64;
+                    load();
+                }
+
+                auto p = block_ + count_trailing_zeros(separators_);
+                separators_ &= separators_ - 1;
+                return p;
+            }
+
+            // input ends inside quotes, valid after next() returned nullptr
+            bool in_quote() const { return in_quote_ != 0; }
+        };
+
+        // passes field of n characters to extractor, strips CR of CRLF and enclosing quotes
+        template<class E, class I>
+        void csv_field(const E& e, I begin, size_t n, bool newline, char quote)
+        {
+            if(newline && n > 0 && *std::next(begin, n - 1) == '\r')
+                --n;
+
+            if(n >= 2 && *begin == quote && *std::next(begin, n - 1) == quote)
+            {
+                ++begin;
+                n -= 2;
+            }
+
+            std::invoke(e, begin, std::next(begin, n));
+        }
+
+        // odd number of quotes in [p, e)
+        inline bool csv_odd_quotes(const char* p, const char* e, char quote)
+        {
+            uint64_t parity = 0;
+            for(; e - p >= 8; p += 8)
+                parity ^= swar_equal(load_le64(p), quote);
+            bool odd = std::bitset<64>(parity).count() & 1;
+            for(; p != e; ++p)
+                odd ^= *p == quote;
+            return odd;
+        }
+
+        // calls field(i1, i2) for each field and record(i1, i2) for each record without line end
+        // in [begin, end) of contiguous input starting at i1, the range must not end inside quotes
+        template<class I, class F, class R>
+        void csv_extract(I i1, const char* begin, const char* end, csv_format fmt, const F& field, const R& record)
+        {
+            csv_scanner scanner(begin, end, fmt);
+            auto record_begin = begin;
+            auto field_begin = begin;
+            while(auto p = scanner.next())
+            {
+                bool newline = *p == '\n';
+                csv_field(field, i1 + (field_begin - begin), p - field_begin, newline, fmt.quote);
+                field_begin = p + 1;
+                if(newline)
+                {
+                    auto n = p - record_begin;
+                    n -= n > 0 && p[-1] == '\r';
+                    std::invoke(record, i1 + (record_begin - begin), i1 + (record_begin - begin + n));
+                    record_begin = p + 1;
+                }
+            }
+
+            if(record_begin != end)
+            {
+                csv_field(field, i1 + (field_begin - begin), end - field_begin, false, fmt.quote);
+                std::invoke(record, i1 + (record_begin - begin), i1 + (end - begin));
+            }
+        }
+
+        // the same for forward iterators
+        template<class I, class F, class R>
+        void csv_extract(I i1, I i2, csv_format fmt, const F& field, const R& record)
+        {
+            bool quoted = false;
+            auto record_begin = i1;
+            auto field_begin = i1;
+            size_t record_length = 0, field_length = 0;
+            for(auto i = i1; i != i2; ++i)
+            {
+                char c = *i;
+                if(c == fmt.quote)
+                    quoted = !quoted;
+                else if(!quoted && (c == fmt.delimiter || c == '\n'))
+                {
+                    bool newline = c == '\n';
+                    csv_field(field, field_begin, field_length, newline, fmt.quote);
+                    field_begin = std::next(i);
+                    field_length = 0;
+                    if(newline)
+                    {
+                        auto n = record_length;
+                        n -= n > 0 && *std::next(record_begin, n - 1) == '\r';
+                        std::invoke(record, record_begin, std::next(record_begin, n));
+                        record_begin = field_begin;
+                        record_length = 0;
+                        continue;
+                    }
+                    ++record_length;
+                    continue;
+                }
+                ++field_length;
+                ++record_length;
+            }
+
+            if(record_begin != i2)
+            {
+                csv_field(field, field_begin, field_length, false, fmt.quote);
+                std::invoke(record, record_begin, i2);
+            }
+        }
+
+        // matches one record (Single) or all records and then calls the extractors,
+        // so a failed match has no side effects; the match fails if input ends inside quotes
+        template<bool Single, class I, class I2, class F, class R>
+        result<I> csv_match(I i1, I2 i2, csv_format fmt, const F& field, const R& record)
+        {
+            if(i1 == i2)
+                return make_result(false, i1);
+
+            if constexpr(is_contiguous_iterator<I> && std::is_same_v<I, I2>
+                && sizeof(typename std::iterator_traits<I>::value_type) == 1)
+            {
+                const char* begin = reinterpret_cast<const char*>(std::addressof(*i1));
+                const char* end = begin + (i2 - i1);
+                if constexpr(Single)
+                {   // the record ends after the first newline outside quotes,
+                    // delimiters of typical records are kept to extract fields without rescanning
+                    std::array<const char*, 32> delimiters;
+                    size_t count = 0;
+                    csv_scanner scanner(begin, end, fmt);
+                    const char* p;
+                    while((p = scanner.next()) && *p != '\n')
+                    {
+                        if(count < delimiters.size())
+                            delimiters[count] = p;
+                        ++count;
+                    }
+
+                    if(!p && scanner.in_quote())
+                        return make_result(false, i1);
+
+                    auto record_end = p ? p : end;
+                    auto next = p ? p + 1 : end;
+                    if(count > delimiters.size())
+                        csv_extract(i1, begin, next, fmt, field, record);
+                    else
+                    {
+                        auto field_begin = begin;
+                        for(size_t k = 0; k < count; ++k)
+                        {
+                            csv_field(field, i1 + (field_begin - begin), delimiters[k] - field_begin, false, fmt.quote);
+                            field_begin = delimiters[k] + 1;
+                        }
+                        csv_field(field, i1 + (field_begin - begin), record_end - field_begin, p != nullptr, fmt.quote);
+
+                        auto n = record_end - begin;
+                        n -= p && n > 0 && p[-1] == '\r';
+                        std::invoke(record, i1, i1 + n);
+                    }
+                    return make_result(true, i1 + (next - begin));
+                }
+                else if(csv_odd_quotes(begin, end, fmt.quote))
+                    return make_result(false, i1);
+
+                csv_extract(i1, begin, end, fmt, field, record);
+                return make_result(true, i1 + (end - begin));
+            }
+            else
+            {
+                static_assert(is_forward_iterator<I>);
+                auto end = find_end(i1, i2);
+                bool quoted = false;
+                auto i = i1;
+                for(; i != end; ++i)
+                {
+                    if(*i == fmt.quote)
+                        quoted = !quoted;
+                    else if(Single && !quoted && *i == '\n')
+                    {
+                        ++i;
+                        break;
+                    }
+                }
+
+                if(quoted)
+                    return make_result(false, i1);
+
+                csv_extract(i1, i, fmt, field, record);
+                return make_result(true, i);
+            }
+        }
+
+        struct csv_ignore
+        {
+            template<class I>
+            void operator() (I, I) const {}
+        };
+    }
+
+    //-------------------------------------------------------------------------
+    /// r_csv_record_t matches one CSV record including its line end and passes each field
+    /// to extractor E as iterator range, enclosing quotes of quoted fields are stripped,
+    /// doubled quotes inside are kept (see csv_unquote); contiguous input is classified
+    /// in 64 byte blocks, quotes toggle quoted regions wherever they appear
+    //-------------------------------------------------------------------------
+    template<class E>
+    class r_csv_record_t final
+    {
+        E e_;
+        csv_format fmt_;
+
+    public:
+        template<class EE>
+        r_csv_record_t(EE&& e, csv_format fmt) : e_(std::forward<EE>(e)), fmt_(fmt) {}
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            return detail::csv_match<true>(i1, i2, fmt_, e_, detail::csv_ignore());
+        }
+
+        const char* name() const { return "r_csv_record"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// r_csv_t matches all records to the end of input in one pass, passes fields to extractor EF
+    /// and records without line end to extractor ER, fails if the input ends inside quotes
+    //-------------------------------------------------------------------------
+    template<class EF, class ER>
+    class r_csv_t final
+    {
+        EF field_;
+        ER record_;
+        csv_format fmt_;
+
+    public:
+        template<class FF, class RR>
+        r_csv_t(FF&& field, RR&& record, csv_format fmt)
+            : field_(std::forward<FF>(field)), record_(std::forward<RR>(record)), fmt_(fmt) {}
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            return detail::csv_match<false>(i1, i2, fmt_, field_, record_);
+        }
+
+        const char* name() const { return "r_csv"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// r_csv_record creates a rule matching one record, e.g.
+    /// +r_csv_record([&](auto i1, auto i2) { fields.emplace_back(i1, i2); }, tsv_format)
+    //-------------------------------------------------------------------------
+    template<class E>
+    auto r_csv_record(E&& e, csv_format fmt = csv_format())
+    {
+        return r_csv_record_t<std::decay_t<E>>(std::forward<E>(e), fmt);
+    }
+
+    inline auto r_csv_record(csv_format fmt = csv_format())
+    {
+        return r_csv_record_t<detail::csv_ignore>(detail::csv_ignore(), fmt);
+    }
+
+    //-------------------------------------------------------------------------
+    /// r_csv creates a rule matching all records, field extractor is called for each field
+    /// and record extractor after fields of each record
+    //-------------------------------------------------------------------------
+    template<class EF, class ER>
+    auto r_csv(EF&& field, ER&& record, csv_format fmt = csv_format())
+    {
+        return r_csv_t<std::decay_t<EF>, std::decay_t<ER>>(std::forward<EF>(field), std::forward<ER>(record), fmt);
+    }
+
+    //-------------------------------------------------------------------------
+    /// csv_unquote replaces doubled quotes in field with single ones
+    //-------------------------------------------------------------------------
+    template<class I>
+    std::string csv_unquote(I i1, I i2, char quote = '"')
+    {
+        std::string s;
+        for(; i1 != i2; ++i1)
+        {
+            s.push_back(*i1);
+            if(*i1 == quote && std::next(i1) != i2 && *std::next(i1) == quote)
+                ++i1;
+        }
+        return s;
+    }
+
+    //-------------------------------------------------------------------------
+    /// csv_split divides text in up to 'parts' chunks of whole records, quote parity
+    /// of the chunks is counted in parallel to find record boundaries outside of quotes
+    //-------------------------------------------------------------------------
+    inline std::vector<std::string_view> csv_split(std::string_view text, size_t parts, csv_format fmt = csv_format())
+    {
+        parts = std::max<size_t>(1, std::min(parts, text.size() / 64));
+        auto size = text.size() / parts;
+        auto begin = text.data(), end = begin + text.size();
+
+        // odd number of quotes in chunk
+        auto odd_quotes = [&](size_t k)
+        {
+            auto p = begin + k * size;
+            return detail::csv_odd_quotes(p, k + 1 == parts ? end : p + size, fmt.quote);
+        };
+
+        std::vector<std::future<bool>> counts;
+        for(size_t k = 1; k < parts; ++k)
+            counts.push_back(std::async(std::launch::async, odd_quotes, k - 1));
+
+        std::vector<std::string_view> chunks;
+        auto chunk_begin = begin;
+        bool in_quote = false;
+        for(size_t k = 1; k < parts; ++k)
+        {
+            in_quote ^= counts[k - 1].get();
+            auto p = begin + k * size;
+            bool quoted = in_quote;
+            if(chunk_begin >= p)
+            {   // the previous chunk extends past this part, continue from its end
+                p = chunk_begin;
+                quoted = false;
+            }
+
+            detail::csv_scanner scanner(p, end, fmt, quoted);
+            const char* newline;
+            while((newline = scanner.next()) && *newline != '\n');
+            if(!newline)
+                break;
+
+            chunks.emplace_back(chunk_begin, newline + 1 - chunk_begin);
+            chunk_begin = newline + 1;
+        }
+
+        if(chunk_begin != end || chunks.empty())
+            chunks.emplace_back(chunk_begin, end - chunk_begin);
+        return chunks;
+    }
+
+    //-------------------------------------------------------------------------
+    /// parse_csv_parallel splits text with csv_split and calls parse_chunk(index, chunk)
+    /// for the chunks concurrently, the function should build its own rules and extractors;
+    /// returns true if all calls returned true
+    //-------------------------------------------------------------------------
+    template<class F>
+    bool parse_csv_parallel(std::string_view text, F&& parse_chunk,
+        size_t parts = std::thread::hardware_concurrency(), csv_format fmt = csv_format())
+    {
+        auto chunks = csv_split(text, parts, fmt);
+        std::vector<std::future<bool>> results;
+        for(size_t k = 1; k < chunks.size(); ++k)
+            results.push_back(std::async(std::launch::async, [&, k] { return bool(std::invoke(parse_chunk, k, chunks[k])); }));
+
+        bool success = std::invoke(parse_chunk, size_t(0), chunks[0]);
+        for(auto& r : results)
+            success = r.get() && success;
+        return success;
+    }
+}
@@ -0,0 +1,887 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include "axe_trait.h"
+#include "axe_exception.h"
+#include "axe_terminal.h"
+#include "axe_composite.h"
+
+namespace axe
+{
+    namespace detail
+    {
+        using byte_set = std::bitset<256>;
+
+        //-------------------------------------------------------------------------
+        // nfa is a Thompson automaton over bytes, used to build dfa
+        //-------------------------------------------------------------------------
+        class nfa
+        {
+        public:
+            struct fragment
+            {
+                size_t start;
+                size_t end;
+            };
+
+            struct state
+            {
+                std::vector<std::pair<byte_set, size_t>> edges;
+                std::vector<size_t> epsilon;
+                int accept = -1;
+            };
+
+            size_t add_state()
+            {
+                states_.emplace_back();
+                return states_.size() - 1;
+            }
+
+            void link(size_t from, size_t to) { states_[from].epsilon.push_back(to); }
+            void accept(const fragment& f, int token) { states_[f.end].accept = token; }
+
+            fragment empty()
+            {
+                auto s = add_state();
+                return { s, s };
+            }
+
+            fragment symbol(const byte_set& bytes)
+            {
+                auto s = add_state();
+                auto e = add_state();
+                states_[s].edges.emplace_back(bytes, e);
+                return { s, e };
+            }
+
+            fragment concat(const fragment& f1, const fragment& f2)
+            {
+                link(f1.end, f2.start);
+                return { f1.start, f2.end };
+            }
+
+            fragment alternate(const fragment& f1, const fragment& f2)
+            {
+                auto s = add_state();
+                auto e = add_state();
+                link(s, f1.start);
+                link(s, f2.start);
+                link(f1.end, e);
+                link(f2.end, e);
+                return { s, e };
+            }
+
+            fragment optional(const fragment& f) { return alternate(f, empty()); }
+
+            fragment star(const fragment& f)
+            {
+                auto s = add_state();
+                link(s, f.start);
+                link(f.end, s);
+                return { s, s };
+            }
+
+            // make is called for each copy of repeated fragment
+            template<class Fn>
+            fragment repeat(Fn&& make, size_t min_occurrence, size_t max_occurrence)
+            {
+                auto f = empty();
+                size_t count = 0;
+                for(; count < min_occurrence; ++count)
+                    f = concat(f, make());
+
+                if(max_occurrence == size_t(-1))
+                    return concat(f, star(make()));
+
+                for(; count < max_occurrence; ++count)
+                    f = concat(f, optional(make()));
+                return f;
+            }
+
+            const std::vector<state>& states() const { return states_; }
+
+        private:
+            std::vector<state> states_;
+        };
+
+        //-------------------------------------------------------------------------
+        // dfa is a minimal deterministic automaton over byte equivalence classes
+        // state 0 is dead, accepting states hold the index of the first matching token rule
+        //-------------------------------------------------------------------------
+        class dfa
+        {
+            std::array<unsigned char, 256> classes_{};
+            size_t class_count_ = 1;
+            std::vector<uint32_t> next_ = std::vector<uint32_t>(1, 0);
+            std::vector<int> accept_ = std::vector<int>(1, -1);
+            uint32_t start_ = 0;
+
+            using state_set = std::vector<size_t>;
+
+            static void closure(const nfa& n, state_set& set)
+            {
+                std::vector<bool> visited(n.states().size());
+                for(auto s : set)
+                    visited[s] = true;
+
+                for(size_t i = 0; i < set.size(); ++i)
+                {
+                    for(auto e : n.states()[set[i]].epsilon)
+                    {
+                        if(!visited[e])
+                        {
+                            visited[e] = true;
+                            set.push_back(e);
+                        }
+                    }
+                }
+                std::sort(set.begin(), set.end());
+            }
+
+            void make_classes(const nfa& n)
+            {
+                classes_.fill(0);
+                class_count_ = 1;
+                for(auto& s : n.states())
+                {
+                    for(auto& edge : s.edges)
+                    {
+                        // split each class by membership in the edge set
+                        std::array<int, 512> split;
+                        split.fill(-1);
+                        size_t count = 0;
+                        for(size_t b = 0; b < 256; ++b)
+                        {
+                            auto& c = split[classes_[b] * 2 + edge.first[b]];
+                            if(c < 0)
+                                c = static_cast<int>(count++);
+                            classes_[b] = static_cast<unsigned char>(c);
+                        }
+                        class_count_ = count;
+                    }
+                }
+            }
+
+            void minimize()
+            {
+                auto size = accept_.size();
+                std::vector<uint32_t> block(size);
+                size_t block_count = 0;
+
+                // initial partition by accepted token, dead state comes first
+                {
+                    std::map<int, uint32_t> blocks;
+                    for(size_t s = 0; s < size; ++s)
+                    {
+                        auto [it, inserted] = blocks.emplace(accept_[s], static_cast<uint32_t>(blocks.size()));
+                        block[s] = it->second;
+                    }
+                    block_count = blocks.size();
+                }
+
+                for(;;)
+                {
+                    std::map<std::vector<uint32_t>, uint32_t> blocks;
+                    std::vector<uint32_t> refined(size);
+                    for(size_t s = 0; s < size; ++s)
+                    {
+                        std::vector<uint32_t> signature(1 + class_count_);
+                        signature[0] = block[s];
+                        for(size_t c = 0; c < class_count_; ++c)
+                            signature[c + 1] = block[next_[s * class_count_ + c]];
+                        auto [it, inserted] = blocks.emplace(std::move(signature), static_cast<uint32_t>(blocks.size()));
+                        refined[s] = it->second;
+                    }
+
+                    block.swap(refined);
+                    if(blocks.size() == block_count)
+                        break;
+                    block_count = blocks.size();
+                }
+
+                // renumber blocks in order of appearance, so that dead state stays 0
+                std::vector<uint32_t> number(block_count, uint32_t(-1));
+                uint32_t count = 0;
+                for(size_t s = 0; s < size; ++s)
+                    if(number[block[s]] == uint32_t(-1))
+                        number[block[s]] = count++;
+
+                std::vector<uint32_t> next(count * class_count_);
+                std::vector<int> accept(count);
+                for(size_t s = 0; s < size; ++s)
+                {
+                    auto b = number[block[s]];
+                    accept[b] = accept_[s];
+                    for(size_t c = 0; c < class_count_; ++c)
+                        next[b * class_count_ + c] = number[block[next_[s * class_count_ + c]]];
+                }
+
+                start_ = number[block[start_]];
+                next_.swap(next);
+                accept_.swap(accept);
+            }
+
+        public:
+            static constexpr uint32_t dead = 0;
+
+            /// default constructed dfa doesn't match anything
+            dfa() { classes_.fill(0); }
+
+            /// subset construction from nfa starting at specified state
+            dfa(const nfa& n, size_t start)
+            {
+                make_classes(n);
+
+                std::array<unsigned char, 256> representative{};
+                for(size_t b = 256; b-- > 0;)
+                    representative[classes_[b]] = static_cast<unsigned char>(b);
+
+                std::map<state_set, uint32_t> states;
+                std::vector<state_set> pending;
+                next_.clear();
+                accept_.clear();
+
+                auto add = [&](state_set&& set)
+                {
+                    auto [it, inserted] = states.emplace(std::move(set), static_cast<uint32_t>(accept_.size()));
+                    if(inserted)
+                    {
+                        int accept = -1;
+                        for(auto s : it->first)
+                        {
+                            auto a = n.states()[s].accept;
+                            if(a >= 0 && (accept < 0 || a < accept))
+                                accept = a;
+                        }
+                        accept_.push_back(accept);
+                        next_.resize(next_.size() + class_count_, dead);
+                        pending.push_back(it->first);
+                    }
+                    return it->second;
+                };
+
+                add(state_set{}); // dead state
+                state_set initial{ start };
+                closure(n, initial);
+                start_ = add(std::move(initial));
+
+                for(size_t d = 1; d < pending.size(); ++d)
+                {
+                    for(size_t c = 0; c < class_count_; ++c)
+                    {
+                        state_set set;
+                        for(auto s : pending[d])
+                            for(auto& edge : n.states()[s].edges)
+                                if(edge.first[representative[c]])
+                                    set.push_back(edge.second);
+
+                        if(!set.empty())
+                        {
+                            std::sort(set.begin(), set.end());
+                            set.erase(std::unique(set.begin(), set.end()), set.end());
+                            closure(n, set);
+                            auto target = add(std::move(set));
+                            next_[d * class_count_ + c] = target;
+                        }
+                    }
+                }
+
+                minimize();
+            }
+
+            size_t size() const { return accept_.size(); }
+            uint32_t start() const { return start_; }
+            int accept(uint32_t state) const { return accept_[state]; }
+
+            uint32_t next(uint32_t state, unsigned char c) const
+            {
+                return next_[state * class_count_ + classes_[c]];
+            }
+
+            /// returns index of the longest matching token rule (or -1) and the end of match
+            template<class Iterator, class Iterator2>
+            std::pair<int, Iterator> longest_match(Iterator i1, Iterator2 i2) const
+            {
+                static_assert(is_forward_iterator<Iterator>);
+                static_assert(sizeof(*i1) == 1, "dfa matches byte sequences");
+
+                auto state = start_;
+                auto token = accept_[state];
+                auto last = i1;
+                for(auto i = i1; i != i2;)
+                {
+                    state = next_[state * class_count_ + classes_[static_cast<unsigned char>(*i)]];
+                    if(state == dead)
+                        break;
+                    ++i;
+                    if(accept_[state] >= 0)
+                    {
+                        token = accept_[state];
+                        last = i;
+                    }
+                }
+                return { token, last };
+            }
+        };
+
+        //-------------------------------------------------------------------------
+        // class_rule trait is true for rules matching a single byte from a set
+        //-------------------------------------------------------------------------
+        template<class R, class = void>
+        struct class_rule : std::false_type {};
+
+        template<class R>
+        using class_rule_t = class_rule<std::remove_cv_t<std::remove_reference_t<R>>>;
+
+        template<class CharT>
+        struct class_rule<r_char<CharT>, std::enable_if_t<sizeof(CharT) == 1>> : std::true_type
+        {
+            static byte_set get(const r_char<CharT>& r)
+            {
+                byte_set bytes;
+                bytes.set(static_cast<unsigned char>(r.value()));
+                return bytes;
+            }
+        };
+
+        template<auto C>
+        struct class_rule<r_strlit<C>, std::enable_if_t<sizeof(C) == 1>> : std::true_type
+        {
+            static byte_set get(const r_strlit<C>&)
+            {
+                byte_set bytes;
+                bytes.set(static_cast<unsigned char>(C));
+                return bytes;
+            }
+        };
+
+        template<class Pred>
+        struct class_rule<r_pred<Pred>, std::enable_if_t<std::is_invocable_r_v<bool, const Pred&, char>>> : std::true_type
+        {
+            static byte_set get(const r_pred<Pred>& r)
+            {
+                byte_set bytes;
+                for(size_t b = 0; b < 256; ++b)
+                    bytes[b] = r.predicate()(static_cast<char>(b));
+                return bytes;
+            }
+        };
+
+        template<class... Rs>
+        struct class_rule<r_or_t<Rs...>, std::enable_if_t<(class_rule_t<Rs>::value && ...)>> : std::true_type
+        {
+            static byte_set get(const r_or_t<Rs...>& r)
+            {
+                return std::apply([](const auto&... rs) { return (class_rule_t<decltype(rs)>::get(rs) | ...); }, r.get());
+            }
+        };
+
+        // set difference produced by r - r1 - r2 ..., which is flattened to !rn & ... & !r1 & r
+        template<class R>
+        constexpr bool is_negated_class_v = false;
+
+        template<class R>
+        constexpr bool is_negated_class_v<r_not_t<R>> = class_rule_t<R>::value;
+
+        template<class Rs, class = std::make_index_sequence<std::tuple_size_v<Rs> - 1>>
+        struct class_difference;
+
+        template<class... Rs, size_t... I>
+        struct class_difference<std::tuple<Rs...>, std::index_sequence<I...>>
+        {
+            using last_t = std::tuple_element_t<sizeof...(I), std::tuple<Rs...>>;
+            static constexpr bool value = class_rule_t<last_t>::value
+                && (is_negated_class_v<std::tuple_element_t<I, std::tuple<Rs...>>> && ...);
+
+            static byte_set get(const std::tuple<Rs...>& rs)
+            {
+                auto bytes = class_rule_t<last_t>::get(std::get<sizeof...(I)>(rs));
+                ((bytes &= ~class_rule_t<decltype(std::get<I>(rs).rule())>::get(std::get<I>(rs).rule())), ...);
+                return bytes;
+            }
+        };
+
+        template<class... Rs>
+        struct class_rule<r_and_t<Rs...>, std::enable_if_t<class_difference<std::tuple<Rs...>>::value>> : std::true_type
+        {
+            static byte_set get(const r_and_t<Rs...>& r) { return class_difference<std::tuple<Rs...>>::get(r.get()); }
+        };
+
+        template<class R>
+        struct class_rule<r_named_t<R>, std::enable_if_t<class_rule_t<R>::value>> : std::true_type
+        {
+            static byte_set get(const r_named_t<R>& r) { return class_rule_t<R>::get(r.rule()); }
+        };
+
+        //-------------------------------------------------------------------------
+        // regular_rule trait is true for rules which can be compiled to nfa
+        // the rules are interpreted as regular expressions (the longest match),
+        // which is the same as PEG semantics for typical token definitions
+        //-------------------------------------------------------------------------
+        template<class R, class = void>
+        struct regular_rule_impl : std::false_type {};
+
+        template<class R, bool = class_rule<R>::value>
+        struct regular_rule : regular_rule_impl<R> {};
+
+        template<class R>
+        struct regular_rule<R, true> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const R& r) { return n.symbol(class_rule<R>::get(r)); }
+        };
+
+        template<class R>
+        using regular_rule_t = regular_rule<std::remove_cv_t<std::remove_reference_t<R>>>;
+
+        template<class R>
+        constexpr bool is_regular_rule_v = regular_rule_t<R>::value;
+
+        template<class Str>
+        nfa::fragment build_string(nfa& n, const Str& str)
+        {
+            auto f = n.empty();
+            for(auto c : str)
+            {
+                byte_set bytes;
+                bytes.set(static_cast<unsigned char>(c));
+                f = n.concat(f, n.symbol(bytes));
+            }
+            return f;
+        }
+
+        template<class CharT>
+        struct regular_rule_impl<r_str<CharT>, std::enable_if_t<sizeof(CharT) == 1>> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_str<CharT>& r)
+            {
+                return build_string(n, std::basic_string_view<CharT>(r.name() ? r.name() : ""));
+            }
+        };
+
+        template<class CharT, class TraitsT, class AllocT>
+        struct regular_rule_impl<r_str<std::basic_string<CharT, TraitsT, AllocT>>, std::enable_if_t<sizeof(CharT) == 1>>
+            : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_str<std::basic_string<CharT, TraitsT, AllocT>>& r)
+            {
+                return build_string(n, r.name());
+            }
+        };
+
+        template<class CharT>
+        struct regular_rule_impl<r_istr<CharT>, std::enable_if_t<sizeof(CharT) == 1>> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_istr<CharT>& r)
+            {
+                auto f = n.empty();
+                for(auto c : r.str())
+                {
+                    byte_set bytes;
+                    bytes.set(static_cast<unsigned char>(c));
+                    if(c >= 'a' && c <= 'z')
+                        bytes.set(static_cast<unsigned char>(c & ~0x20));
+                    f = n.concat(f, n.symbol(bytes));
+                }
+                return f;
+            }
+        };
+
+        template<auto C1, auto... C>
+        struct regular_rule_impl<r_strlit<C1, C...>, std::enable_if_t<sizeof(C1) == 1>> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_strlit<C1, C...>&)
+            {
+                return build_string(n, std::array<decltype(C1), 1 + sizeof...(C)>{ C1, C... });
+            }
+        };
+
+        template<>
+        struct regular_rule_impl<r_empty> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_empty&) { return n.empty(); }
+        };
+
+        template<>
+        struct regular_rule_impl<r_ident> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_ident&)
+            {
+                return n.concat(regular_rule<r_pred<is_alpha>>::build(n, r_pred<is_alpha>(is_alpha())),
+                    n.star(regular_rule<r_pred<is_alnum>>::build(n, r_pred<is_alnum>(is_alnum()))));
+            }
+        };
+
+        template<class Pred, bool Occurrence>
+        struct regular_rule_impl<r_predstr<Pred, Occurrence>, std::enable_if_t<class_rule<r_pred<Pred>>::value>>
+            : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_predstr<Pred, Occurrence>& r)
+            {
+                auto bytes = class_rule<r_pred<Pred>>::get(r_pred<Pred>(r.predicate()));
+                auto make = [&] { return n.symbol(bytes); };
+                if constexpr(Occurrence)
+                    return n.repeat(make, r.min_occurrence(), r.max_occurrence());
+                else
+                    return n.repeat(make, 1, -1);
+            }
+        };
+
+        template<class R, class S>
+        struct regular_rule_impl<r_many_t<R, S>,
+            std::enable_if_t<is_regular_rule_v<R> && is_regular_rule_v<S>>> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_many_t<R, S>& r)
+            {
+                auto min_occurrence = r.min_occurrence();
+                auto max_occurrence = r.max_occurrence();
+                auto make = [&] { return regular_rule_t<R>::build(n, r.rule()); };
+
+                if constexpr(std::is_same_v<std::decay_t<S>, r_empty>)
+                    return n.repeat(make, min_occurrence, max_occurrence);
+                else
+                {
+                    if(max_occurrence == 0)
+                        return n.empty();
+
+                    // r (s r){min - 1, max - 1}
+                    auto make_next = [&] { return n.concat(regular_rule_t<S>::build(n, r.separator()), make()); };
+                    auto f = n.concat(make(), n.repeat(make_next, min_occurrence ? min_occurrence - 1 : 0,
+                        max_occurrence == size_t(-1) ? max_occurrence : max_occurrence - 1));
+                    return min_occurrence ? f : n.optional(f);
+                }
+            }
+        };
+
+        template<class... Rs>
+        struct regular_rule_impl<r_or_t<Rs...>, std::enable_if_t<(is_regular_rule_v<Rs> && ...)>> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_or_t<Rs...>& r)
+            {
+                return std::apply([&](const auto&... rs)
+                {
+                    std::array<nfa::fragment, sizeof...(Rs)> fs{ regular_rule_t<decltype(rs)>::build(n, rs)... };
+                    auto f = fs[0];
+                    for(size_t i = 1; i < fs.size(); ++i)
+                        f = n.alternate(f, fs[i]);
+                    return f;
+                }, r.get());
+            }
+        };
+
+        template<class... Rs>
+        struct regular_rule_impl<r_and_t<Rs...>, std::enable_if_t<(is_regular_rule_v<Rs> && ...)>> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_and_t<Rs...>& r)
+            {
+                return std::apply([&](const auto&... rs)
+                {
+                    std::array<nfa::fragment, sizeof...(Rs)> fs{ regular_rule_t<decltype(rs)>::build(n, rs)... };
+                    auto f = fs[0];
+                    for(size_t i = 1; i < fs.size(); ++i)
+                        f = n.concat(f, fs[i]);
+                    return f;
+                }, r.get());
+            }
+        };
+
+        template<class R>
+        struct regular_rule_impl<r_opt_t<R>, std::enable_if_t<is_regular_rule_v<R>>> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_opt_t<R>& r)
+            {
+                return n.optional(regular_rule_t<R>::build(n, r.rule()));
+            }
+        };
+
+        template<class R>
+        struct regular_rule_impl<r_named_t<R>, std::enable_if_t<is_regular_rule_v<R>>> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const r_named_t<R>& r)
+            {
+                return regular_rule_t<R>::build(n, r.rule());
+            }
+        };
+
+        template<class R>
+        struct regular_rule_impl<std::reference_wrapper<R>, std::enable_if_t<is_regular_rule_v<R>>> : std::true_type
+        {
+            static nfa::fragment build(nfa& n, const std::reference_wrapper<R>& r)
+            {
+                return regular_rule_t<R>::build(n, r.get());
+            }
+        };
+
+        //-------------------------------------------------------------------------
+        // make_dfa compiles token rules to dfa, token index is the rule position
+        //-------------------------------------------------------------------------
+        template<class... R>
+        dfa make_dfa(const R&... rules)
+        {
+            static_assert((is_regular_rule_v<R> && ...), "rules must be regular (r_char, r_str, r_pred, r_predstr, r_many, |, &, ~)");
+
+            nfa n;
+            auto root = n.add_state();
+            int token = 0;
+            ((void)[&](const auto& r)
+            {
+                auto f = regular_rule_t<decltype(r)>::build(n, r);
+                n.accept(f, token++);
+                n.link(root, f.start);
+            }(rules), ...);
+
+            return dfa(n, root);
+        }
+    }
+
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // dfa consumes the longest matching text, while combinators take the first matching
+        // alternative and repeat greedily without backtracking; peg_check rejects rules
+        // where the results can differ: an alternative matching a proper prefix of a later one,
+        // and a rule followed by a rule which can start with a character extending its match
+        //-------------------------------------------------------------------------
+        template<class Fn>
+        dfa fragment_dfa(Fn&& build)
+        {
+            nfa n;
+            auto f = build(n);
+            n.accept(f, 0);
+            return dfa(n, f.start);
+        }
+
+        inline bool dfa_nullable(const dfa& d) { return d.accept(d.start()) >= 0; }
+
+        // characters starting a non-empty match
+        inline byte_set dfa_first(const dfa& d)
+        {
+            byte_set bytes;
+            for(size_t b = 0; b < 256; ++b)
+                bytes[b] = d.next(d.start(), static_cast<unsigned char>(b)) != dfa::dead;
+            return bytes;
+        }
+
+        // characters continuing a complete match to a longer one, states of minimal dfa
+        // are reachable and all live states lead to a match
+        inline byte_set dfa_extension(const dfa& d)
+        {
+            byte_set bytes;
+            for(uint32_t s = 0; s < d.size(); ++s)
+            {
+                if(d.accept(s) < 0)
+                    continue;
+                for(size_t b = 0; b < 256; ++b)
+                    bytes[b] = bytes[b] || d.next(s, static_cast<unsigned char>(b)) != dfa::dead;
+            }
+            return bytes;
+        }
+
+        // true if a match of the first dfa is a proper prefix of a match of the second
+        inline bool dfa_prefix_of(const dfa& d1, const dfa& d2)
+        {
+            std::vector<bool> visited(d1.size() * d2.size());
+            std::vector<std::pair<uint32_t, uint32_t>> pending{ { d1.start(), d2.start() } };
+            visited[d1.start() * d2.size() + d2.start()] = true;
+            while(!pending.empty())
+            {
+                auto [s1, s2] = pending.back();
+                pending.pop_back();
+                for(size_t b = 0; b < 256; ++b)
+                {
+                    auto c = static_cast<unsigned char>(b);
+                    auto n2 = d2.next(s2, c);
+                    if(n2 == dfa::dead)
+                        continue;
+                    if(d1.accept(s1) >= 0)
+                        return true;
+
+                    auto n1 = d1.next(s1, c);
+                    if(n1 != dfa::dead && !visited[n1 * d2.size() + n2])
+                    {
+                        visited[n1 * d2.size() + n2] = true;
+                        pending.emplace_back(n1, n2);
+                    }
+                }
+            }
+            return false;
+        }
+
+        template<class R, class = void>
+        struct peg_check_impl
+        {   // terminals match one text at each position or repeat a character class
+            static void check(const R&) {}
+        };
+
+        template<class R>
+        void peg_check(const R& r)
+        {
+            using rule_t = std::remove_cv_t<std::remove_reference_t<R>>;
+            if constexpr(!class_rule<rule_t>::value)
+                peg_check_impl<rule_t>::check(r);
+        }
+
+        template<class... Rs>
+        struct peg_check_impl<r_or_t<Rs...>>
+        {
+            static void check(const r_or_t<Rs...>& r)
+            {
+                std::apply([](const auto&... rs)
+                {
+                    (peg_check(rs), ...);
+                    std::array<dfa, sizeof...(Rs)> ds{ make_dfa(rs)... };
+                    for(size_t i = 0; i < ds.size(); ++i)
+                        for(size_t j = i + 1; j < ds.size(); ++j)
+                            if(dfa_prefix_of(ds[i], ds[j]))
+                                throw_failure("r_dfa: alternative " + std::to_string(i + 1)
+                                    + " matches a prefix of alternative " + std::to_string(j + 1));
+                }, r.get());
+            }
+        };
+
+        template<class... Rs>
+        struct peg_check_impl<r_and_t<Rs...>>
+        {
+            static void check(const r_and_t<Rs...>& r)
+            {
+                std::apply([](const auto&... rs)
+                {
+                    (peg_check(rs), ...);
+                    std::array<dfa, sizeof...(Rs)> ds{ make_dfa(rs)... };
+                    byte_set first_after; // the first characters of the rest of sequence
+                    for(size_t i = ds.size(); i-- > 0;)
+                    {
+                        if((dfa_extension(ds[i]) & first_after).any())
+                            throw_failure("r_dfa: rule " + std::to_string(i + 1)
+                                + " of sequence can be extended by the first character of the following rules");
+
+                        first_after = dfa_first(ds[i]) | (dfa_nullable(ds[i]) ? first_after : byte_set());
+                    }
+                }, r.get());
+            }
+        };
+
+        template<class R, class S>
+        struct peg_check_impl<r_many_t<R, S>>
+        {
+            static void check(const r_many_t<R, S>& r)
+            {
+                peg_check(r.rule());
+                peg_check(r.separator());
+                if(r.max_occurrence() < 2)
+                    return;
+
+                // repeated unit must not be extended by its own first characters
+                auto item = make_dfa(r.rule());
+                auto unit = std::is_same_v<std::decay_t<S>, r_empty> ? item : fragment_dfa([&](nfa& n)
+                {
+                    return n.concat(regular_rule_t<S>::build(n, r.separator()), regular_rule_t<R>::build(n, r.rule()));
+                });
+
+                auto first = dfa_first(unit);
+                if((dfa_extension(item) & first).any() || (dfa_extension(unit) & first).any())
+                    throw_failure("r_dfa: repeated rule can be extended by the first character of the next repetition");
+            }
+        };
+
+        template<class R>
+        struct peg_check_impl<r_opt_t<R>>
+        {
+            static void check(const r_opt_t<R>& r) { peg_check(r.rule()); }
+        };
+
+        template<class R>
+        struct peg_check_impl<r_named_t<R>>
+        {
+            static void check(const r_named_t<R>& r) { peg_check(r.rule()); }
+        };
+
+        template<class R>
+        struct peg_check_impl<std::reference_wrapper<R>>
+        {
+            static void check(const std::reference_wrapper<R>& r) { peg_check(r.get()); }
+        };
+    }
+
+    //-------------------------------------------------------------------------
+    /// r_dfa compiles regular rule to minimal dfa at construction time and matches it
+    /// in a single pass without backtracking; dfa consumes the longest matching text,
+    /// so rules where ordered choice or greedy repetition would match differently
+    /// (e.g. 'a' | "ab"_axe, *_d & _d) throw failure at construction,
+    /// rules with extractors, recursive rules (r_rule) and other non-regular rules are rejected
+    //-------------------------------------------------------------------------
+    class r_dfa final
+    {
+        std::shared_ptr<const detail::dfa> dfa_;
+
+    public:
+        template<class R, class = detail::disable_copy<R, r_dfa>>
+        explicit r_dfa(const R& r)
+        {
+            static_assert(detail::is_regular_rule_v<R>,
+                "r_dfa requires regular rule without extractors or recursion (r_char, r_str, r_pred, r_predstr, r_many, |, &, ~)");
+            detail::peg_check(r);
+            dfa_ = std::make_shared<const detail::dfa>(detail::make_dfa(r));
+        }
+
+        template<class I, class I2>
+        result<I> operator() (I i1, I2 i2) const
+        {
+            static_assert(is_forward_iterator<I>);
+            auto [token, i] = dfa_->longest_match(i1, i2);
+            return make_result(token >= 0, i, i1);
+        }
+
+        /// compiled automaton, used by reflection
+        const detail::dfa& automaton() const { return *dfa_; }
+        const char* name() const { return "r_dfa"; }
+    };
+
+    namespace detail
+    {
+        template<class R>
+        struct iterator_independent_rule<R, std::enable_if_t<is_regular_rule_v<R>>> : std::true_type {};
+
+        template<>
+        struct iterator_independent_rule<r_dfa> : std::true_type {};
+    }
+}
@@ -48,8 +48,8 @@ namespace axe
         std::string msg;
         std::array<charT, buflen> str; // buffer
     public:
-        template<class T, class I>
-        failure(T&& msg, I i1, I i2) : msg(std::forward<T>(msg))
+        template<class T, class I, class I2>
+        failure(T&& msg, I i1, I2 i2) : msg(std::forward<T>(msg))
         {
             str.fill(0);
             for(size_t i = 0; i1 != i2 && i < str.size() - 1; ++i, ++i1)
@@ -77,8 +77,8 @@ namespace axe
         }
     };
 
-    template<class I>
-    inline void throw_failure(std::string msg, I i1, I i2) // [[noreturn]]
+    template<class I, class I2>
+    inline void throw_failure(std::string msg, I i1, I2 i2) // [[noreturn]]
     {
         throw failure<typename std::iterator_traits<I>::value_type>(std::move(msg), i1, i2);
     }
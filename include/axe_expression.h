@@ -51,13 +51,13 @@ namespace axe
     template<class T>
     struct r_group_t
     {
-        T& value_;
-        explicit r_group_t(T& value) : value_(value) {}
+        detail::binding<T> value_;
+        explicit r_group_t(detail::binding<T> value) : value_(value) {}
 
         template<class It>
         result<It> operator() (It i1, It i2) const
         {
-            return ('(' & r_expression<T>(value_) & ')')(i1, i2);
+            return ('(' & r_expression<detail::bound_t<T>>(value_.get()) & ')')(i1, i2);
         }
     };
 
@@ -67,16 +67,18 @@ namespace axe
     template<class T>
     struct r_factor_t
     {
-        T& value_;
-        explicit r_factor_t(T& value) : value_(value) {}
+        detail::binding<T> value_;
+        explicit r_factor_t(detail::binding<T> value) : value_(value) {}
 
         template<class It>
         result<It> operator() (It i1, It i2) const
         {
-            if constexpr(std::is_floating_point_v<T>)
-                return (r_double(value_) | r_group_t<T>(value_))(i1, i2);
+            using value_type = detail::bound_t<T>;
+            auto& value = value_.get();
+            if constexpr(std::is_floating_point_v<value_type>)
+                return (r_double(value) | r_group_t<value_type>(value))(i1, i2);
             else
-                return (r_decimal(value_) | r_group_t<T>(value_))(i1, i2);
+                return (r_decimal(value) | r_group_t<value_type>(value))(i1, i2);
         }
     };
 
@@ -86,43 +88,49 @@ namespace axe
     template<class T>
     struct r_term_t
     {
-        T& value_;
-        explicit r_term_t(T& value) : value_(value) {}
+        detail::binding<T> value_;
+        explicit r_term_t(detail::binding<T> value) : value_(value) {}
 
         template<class It>
         result<It> operator() (It i1, It i2) const
         {
-            T t;
-            return (r_factor_t<T>(value_)
-                & *( '*' & r_factor_t<T>(t) >> [&] { value_ *= t; }
-                | '/' & r_factor_t<T>(t) >> [&] { value_ /= t; }
+            using value_type = detail::bound_t<T>;
+            auto& value = value_.get();
+            value_type t;
+            return (r_factor_t<value_type>(value)
+                & *( '*' & r_factor_t<value_type>(t) >> [&] { value *= t; }
+                | '/' & r_factor_t<value_type>(t) >> [&] { value /= t; }
                 ))(i1, i2);
         }
     };
 
     //-------------------------------------------------------------------------
-    /// r_expression - rule for expression
+    /// r_expression - rule for expression, value is a variable or a slot of parse context
     //-------------------------------------------------------------------------
     template<class T>
     struct r_expression
     {
-        T& value_;
-        explicit r_expression(T& value) : value_(value) {}
+        detail::binding<T> value_;
+        explicit r_expression(detail::binding<T> value) : value_(value) {}
 
         template<class It>
         result<It> operator() (It i1, It i2) const
         {
-			T t{};
+            using value_type = detail::bound_t<T>;
+            auto& value = value_.get();
+			value_type t{};
             return
-                (r_term_t<T>(value_)
-                    & *('+' & r_term_t<T>(t) >> [&] { value_ += t; } 
-                    | '-' & r_term_t<T>(t) >> [&] { value_ -= t; }
+                (r_term_t<value_type>(value)
+                    & *('+' & r_term_t<value_type>(t) >> [&] { value += t; } 
+                    | '-' & r_term_t<value_type>(t) >> [&] { value -= t; }
                     ))(i1, i2);
         }
     };
 
     template<class T>
     r_expression(T&)->r_expression<T>;
+    template<class Ctx, class T>
+    r_expression(slot<Ctx, T>)->r_expression<slot<Ctx, T>>;
 
     template<class T, class C, class Traits, class Alloc>
     inline auto parse_expression(const std::basic_string<C, Traits, Alloc>& str, T def_value)
@@ -40,6 +40,7 @@
 #include "axe_iterator.h"
 #include "axe_detail.h"
 #include "axe_composite.h"
+#include "axe_context.h"
 
 namespace axe
 {
@@ -82,6 +83,10 @@ namespace axe
 
             return i;
         }
+
+        const R& rule() const { return r_; }
+        const E& extractor() const { return e_; }
+
     #if defined(AXE_ALLOW_PARSE_TREE_EXTRACTION)
         //---------------------------------------------------------------------
         template<class Iterator>
@@ -468,6 +473,23 @@ namespace axe
         }
     };
 
+    //-------------------------------------------------------------------------
+    /// extractor specialized for slot of parse context, value is extracted to the context member
+    //-------------------------------------------------------------------------
+    template<class Ctx, class T>
+    class e_value_t<slot<Ctx, T>>
+    {
+        slot<Ctx, T> slot_;
+    public:
+        explicit e_value_t(const slot<Ctx, T>& s) : slot_(s) {}
+
+        template<class Iterator, class Iterator2>
+        void operator() (Iterator i1, Iterator2 i2) const
+        {
+            e_value_t<T>(slot_.get())(i1, i2);
+        }
+    };
+
     //-------------------------------------------------------------------------
     /// reference wrapper for extractor (backward compatibility with v.1)
     //-------------------------------------------------------------------------
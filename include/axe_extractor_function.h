@@ -63,5 +63,16 @@ namespace axe
             return r_extractor_t<std::decay_t<R>, e_value_t<T>>(std::forward<R>(r), e_value_t<T>(t));
         }
 
+        //-------------------------------------------------------------------------
+        template<class R, class Ctx, class T>
+        r_extractor_t<
+            detail::enable_if_rule<R>,
+            e_value_t<slot<Ctx, T>>
+        >
+            operator >> (R&& r, const slot<Ctx, T>& s)
+        {
+            return r_extractor_t<std::decay_t<R>, e_value_t<slot<Ctx, T>>>(std::forward<R>(r), e_value_t<slot<Ctx, T>>(s));
+        }
+
     }
 }
@@ -30,6 +30,11 @@
 
 #include <type_traits>
 #include <vector>
+#include <array>
+#include <utility>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
 #include <assert.h>
 
 #include "axe_exception.h"
@@ -68,6 +73,73 @@ namespace axe
     template<class I>
     it_pair(I, I)->it_pair<I>;
 
+    //-------------------------------------------------------------------------
+    // end of NUL terminated sequence, lets rules parse C strings without strlen,
+    // the terminator is found by the same comparisons that check for the end
+    //-------------------------------------------------------------------------
+    struct null_sentinel
+    {
+        template<class I, class = decltype(*std::declval<const I&>() == 0)>
+        friend constexpr bool operator== (const I& i, null_sentinel) { return *i == 0; }
+
+        template<class I, class = decltype(*std::declval<const I&>() == 0)>
+        friend constexpr bool operator== (null_sentinel, const I& i) { return *i == 0; }
+
+        template<class I, class = decltype(*std::declval<const I&>() == 0)>
+        friend constexpr bool operator!= (const I& i, null_sentinel) { return *i != 0; }
+
+        template<class I, class = decltype(*std::declval<const I&>() == 0)>
+        friend constexpr bool operator!= (null_sentinel, const I& i) { return *i != 0; }
+    };
+
+    //-------------------------------------------------------------------------
+    // returns the end iterator of the range [i, s), walking to the sentinel if necessary
+    //-------------------------------------------------------------------------
+    template<class I, class S>
+    constexpr I find_end(I i, S s)
+    {
+        if constexpr(std::is_same_v<I, S>)
+            return s;
+        else
+        {
+            for(; i != s; ++i);
+            return i;
+        }
+    }
+
+    namespace detail
+    {
+        // iterators that can skip elements in bulk (input_buffer)
+        template<class I, class = void>
+        constexpr bool has_bulk_advance_v = false;
+
+        template<class I>
+        constexpr bool has_bulk_advance_v<I, std::void_t<decltype(std::declval<I&>().advance(size_t(), std::declval<const I&>()))>> = true;
+
+        // advances iterator by n elements, fails if the range is shorter,
+        // random access iterators are checked and advanced in constant time,
+        // iterators that must see the end by comparison (push_iterator) are forward and walk
+        template<class I, class I2>
+        bool advance_bounded(I& i1, I2 i2, uint64_t n)
+        {
+            if constexpr(is_random_access_iterator<I> && std::is_same_v<I, I2>)
+            {
+                if(uint64_t(i2 - i1) < n)
+                    return false;
+
+                i1 += static_cast<typename std::iterator_traits<I>::difference_type>(n);
+                return true;
+            }
+            else if constexpr(has_bulk_advance_v<I> && std::is_same_v<I, I2>)
+                return i1.advance(n, i2);
+            else
+            {
+                for(; n && i1 != i2; --n, ++i1);
+                return n == 0;
+            }
+        }
+    }
+
     //-------------------------------------------------------------------------
     template<class I, class R>
     constexpr const bool is_extracting_rule_v = takes_args_v< std::decay_t<R>, it_pair<I>>;
@@ -162,6 +234,127 @@ namespace axe
     template<class I, class Fun>
     skip_iterator(I, I, Fun&&)->skip_iterator<I, std::decay_t<Fun>>;
 
+    //-------------------------------------------------------------------------
+    // skip_cache remembers the next significant position for each visited offset
+    // of random access range, so repeated skipping after backtracking is O(1);
+    // the table is split in blocks allocated on the first visit, the first block is inline,
+    // so the cost is proportional to the visited part of the range
+    //-------------------------------------------------------------------------
+    template<class I, class F>
+    class skip_cache
+    {
+        static_assert(is_random_access_iterator<I>);
+        static_assert(AXE_IS_RULE(F), "skip_cache requires rule skipper");
+
+        // distance to the next significant element plus one, zero for positions not visited yet
+        static constexpr size_t block_size = 64;
+        using block = std::array<uint32_t, block_size>;
+
+        I begin_;
+        I end_;
+        const F& fun_;
+        mutable block first_{};
+        mutable std::vector<std::unique_ptr<block>> blocks_;
+
+        uint32_t* find(size_t offset, bool create) const
+        {
+            if(offset < block_size)
+                return &first_[offset];
+
+            auto index = offset / block_size - 1;
+            if(index >= blocks_.size())
+            {
+                if(!create)
+                    return nullptr;
+                blocks_.resize(index + 1);
+            }
+            if(!blocks_[index])
+            {
+                if(!create)
+                    return nullptr;
+                blocks_[index] = std::make_unique<block>();
+            }
+            return &(*blocks_[index])[offset % block_size];
+        }
+
+    public:
+        skip_cache(I begin, I end, const F& fun) : begin_(begin), end_(end), fun_(fun) {}
+
+        skip_cache(const skip_cache&) = delete;
+        skip_cache& operator= (const skip_cache&) = delete;
+
+        I begin() const { return begin_; }
+        I end() const { return end_; }
+
+        I skip(I it) const
+        {
+            if(it == end_)
+                return it;
+
+            auto offset = size_t(it - begin_);
+            if(auto distance = find(offset, false); distance && *distance)
+                return it + (*distance - 1);
+
+            auto next = it;
+            while(next != end_)
+            {
+                auto match = fun_(next, end_);
+                if(!match.matched)
+                    break;
+                next = match.position;
+            }
+
+            auto distance = size_t(next - it);
+            if(distance < uint32_t(-1))
+                *find(offset, true) = uint32_t(distance + 1);
+            return next;
+        }
+
+        void inc(I& it) const
+        {
+            if(it != end_) ++it;
+            it = skip(it);
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    // cached_skip_iterator is a position in skip_cache, it is cheap to copy
+    //-------------------------------------------------------------------------
+    template<class I, class F>
+    class cached_skip_iterator
+    {
+        const skip_cache<I, F>* cache_ = nullptr;
+        I it_{};
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = typename std::iterator_traits<I>::difference_type;
+        using value_type = typename std::iterator_traits<I>::value_type;
+        using pointer = typename std::iterator_traits<I>::pointer;
+        using reference = typename std::iterator_traits<I>::reference;
+
+        cached_skip_iterator() = default;
+        cached_skip_iterator(const skip_cache<I, F>& cache, I it) : cache_(&cache), it_(cache.skip(it)) {}
+
+        I get() const { return it_; }
+        bool empty() const { return it_ == cache_->end(); }
+
+        auto& operator++ () { cache_->inc(it_); return *this; }
+        auto operator++ (int) { auto tmp = *this; cache_->inc(it_); return tmp; }
+        auto operator+ (size_t dist) const
+        {
+            auto tmp = *this;
+            for(; !tmp.empty() && dist > 0; --dist)
+                ++tmp;
+            return tmp;
+        }
+
+        decltype(auto) operator* () const { return *it_; }
+        auto operator->() const { return &*it_; }
+        bool operator== (const cached_skip_iterator& other) const { return it_ == other.it_; }
+        bool operator!= (const cached_skip_iterator& other) const { return !operator==(other); }
+    };
+
 
     //-------------------------------------------------------------------------
     // skips characters which satisfy F (either predicate or rule)
@@ -266,6 +459,13 @@ namespace axe
     //-------------------------------------------------------------------------
     // converting iterator
     //-------------------------------------------------------------------------
+    // sentinel of the converting iterator wraps the sentinel of the underlying iterator
+    template<class S>
+    struct convert_sentinel
+    {
+        S end;
+    };
+
     template<class I, class F>
     class convert_iterator
     {
@@ -280,6 +480,8 @@ namespace axe
         using reference = typename std::iterator_traits<I>::reference;
 
         convert_iterator(I it, F fun) : it_(it), fun_(std::move(fun)) {}
+        convert_iterator(const convert_iterator&) = default;
+        convert_iterator& operator= (const convert_iterator&) = default;
         convert_iterator& operator++ () { ++it_; return *this; }
         convert_iterator operator++ (int) { auto tmp = *this; ++it_; return tmp; }
         value_type operator* () const
@@ -291,18 +493,21 @@ namespace axe
 
         bool operator== (const convert_iterator& other) const { return it_ == other.it_; }
         bool operator!= (const convert_iterator& other) const { return !operator==(other); }
-        convert_iterator& operator= (const convert_iterator& i) { it_ = i.it_; fun_ = i.fun_; return *this; }
+        template<class S> bool operator== (const convert_sentinel<S>& s) const { return it_ == s.end; }
+        template<class S> bool operator!= (const convert_sentinel<S>& s) const { return it_ != s.end; }
         I get() const { return it_; }
     };
 
     //-------------------------------------------------------------------------
-    template<class I, template<class, class> class C = std::vector, class A = std::allocator<typename I::value_type>>
+    template<class I, template<class, class> class C = std::vector, 
+        class A = std::allocator<typename std::iterator_traits<I>::value_type>, class S = I>
     class input_buffer
     {
         friend class iterator;
         I it_; // always points to position that hasn't been read
-        I end_;
-        C<typename I::value_type, A> buffer_;
+        S end_;
+        C<typename std::iterator_traits<I>::value_type, A> buffer_;
+        size_t base_ = 0; // position of the first buffered element
 
         bool read_from_input()
         {
@@ -314,13 +519,34 @@ namespace axe
             }
             return false;
         }
+        size_t read_block(size_t count)
+        {   // reads upto 'count' elements, returns the number of elements read
+            if constexpr(is_random_access_iterator<I> && std::is_same_v<I, S>)
+            {
+                auto n = std::min(count, size_t(end_ - it_));
+                buffer_.insert(buffer_.end(), it_, it_ + n);
+                it_ += n;
+                return n;
+            }
+            else
+            {
+                size_t n = 0;
+                for(; n < count && it_ != end_; ++n, ++it_)
+                    buffer_.push_back(*it_);
+                return n;
+            }
+        }
         bool valid(size_t position) const { return position != size_t(-1); }
+        bool at_end(size_t position)
+        {   // position after the last read element is the end if nothing more can be read
+            return !valid(position) || (position == base_ + buffer_.size() && !read_from_input());
+        }
         bool sync(size_t position)
         {   // reads data upto 'position' if necessary
             bool success = valid(position);
 
-            if(position > buffer_.size())
-                for(size_t dist = position - buffer_.size(); dist && success; --dist)
+            if(position > base_ + buffer_.size())
+                for(size_t dist = position - base_ - buffer_.size(); dist && success; --dist)
                     success = read_from_input();
 
             return success;
@@ -331,32 +557,53 @@ namespace axe
             if(valid(position) && sync(position + 1))
             {
                 ++position;
-                if(position == buffer_.size() && it_ == end_)
+                if(position == base_ + buffer_.size() && it_ == end_)
                     position = -1;
             }
             else
                 position = -1;
         }
 
-        typename I::reference get_ref(size_t position)
+        bool skip(size_t& position, size_t n)
+        {   // advances position by n elements reading input in one block
+            if(n == 0)
+                return true;
+
+            auto available = base_ + buffer_.size();
+            if(!valid(position) || (position + n > available && read_block(position + n - available) < position + n - available))
+            {
+                position = -1;
+                return false;
+            }
+
+            position += n;
+            if(position == base_ + buffer_.size() && it_ == end_)
+                position = -1;
+            return true;
+        }
+
+        typename std::iterator_traits<I>::reference get_ref(size_t position)
         {
-            if(position >= buffer_.size() && (!sync(position) || !read_from_input()))
+            if(position >= base_ + buffer_.size() && (!sync(position) || !read_from_input()))
                 throw_failure("input_buffer: dereferencing end iterator");
-            return buffer_[position];
+            if(position < base_)
+                throw_failure("input_buffer: dereferencing released iterator");
+            return buffer_[position - base_];
         }
 
         I get_iter(size_t position) const
         {
-            if(valid(position) && position != buffer_.size())
+            if(valid(position) && position != base_ + buffer_.size())
                 throw_failure("input_buffer: rollback not possible");
             return it_;
         }
 
     public:
-        input_buffer(I begin, I end) : it_(begin), end_(end) {}
+        input_buffer(I begin, S end) : it_(begin), end_(end) {}
 
         class iterator
         {
+            friend class input_buffer;
             input_buffer&   buf_;
             size_t          position_;
         public:
@@ -367,20 +614,102 @@ namespace axe
             using reference = typename std::iterator_traits<I>::reference;
 
             iterator(input_buffer& buf, size_t position) : buf_(buf), position_(position) {}
+            iterator(const iterator&) = default;
 
             iterator& operator++ () { buf_.inc(position_); return *this; }
             iterator operator++ (int) { auto tmp = *this; buf_.inc(position_); return tmp; }
 
             reference operator* () const { return buf_.get_ref(position_); }
-            bool operator== (const iterator& other) const { return &buf_ == &other.buf_ && position_ == other.position_; }
+            bool operator== (const iterator& other) const
+            {
+                return &buf_ == &other.buf_
+                    && (position_ == other.position_ || (buf_.at_end(position_) && buf_.at_end(other.position_)));
+            }
             bool operator!= (const iterator& other) const { return !operator==(other); }
             iterator& operator= (const iterator& i) { assert(&buf_ == &i.buf_); position_ = i.position_; return *this; }
 
             I get() const { return buf_.get_iter(position_); }
+
+            /// advances by n elements not past 'last', the input is read in one block
+            bool advance(size_t n, const iterator& last)
+            {
+                if(buf_.valid(position_) && buf_.valid(last.position_))
+                {
+                    if(last.position_ - position_ < n)
+                        return false;
+
+                    position_ += n;
+                    return true;
+                }
+                return buf_.skip(position_, n);
+            }
         };
 
-        iterator begin() { return iterator(*this, 0); }
+        iterator begin() { return iterator(*this, base_); }
         iterator end() { return iterator(*this, -1); }
+
+        /// discards buffered elements before the iterator, which can't be dereferenced anymore,
+        /// memory is bounded by the distance between the released and the furthest read position
+        void release(const iterator& i)
+        {
+            if(valid(i.position_) && i.position_ < base_)
+                return; // already released
+
+            auto count = valid(i.position_) ? i.position_ - base_ : buffer_.size();
+            if(count > 0 && count * 2 >= buffer_.size())
+            {
+                buffer_.erase(buffer_.begin(), buffer_.begin() + count);
+                base_ += count;
+            }
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    // order of bits in bytes of bit stream: msb_first reads bit 7 first (network
+    // protocols, video headers), lsb_first reads bit 0 first (deflate)
+    //-------------------------------------------------------------------------
+    enum class bit_order { msb_first, lsb_first };
+
+    //-------------------------------------------------------------------------
+    // bit_iterator iterates over bits of byte input, any rule can match it bit by bit,
+    // r_bits and r_bit_pattern read multi bit fields at once
+    //-------------------------------------------------------------------------
+    template<class I, bit_order Order = bit_order::msb_first>
+    class bit_iterator
+    {
+        static_assert(sizeof(typename std::iterator_traits<I>::value_type) == 1, "bit_iterator requires byte input");
+        I it_{};
+        unsigned bit_ = 0; // number of bits read from *it_
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = typename std::iterator_traits<I>::difference_type;
+        using value_type = bool;
+        using pointer = void;
+        using reference = bool;
+
+        bit_iterator() = default;
+        explicit bit_iterator(I it, unsigned bit = 0) : it_(it), bit_(bit) { assert(bit < 8); }
+
+        bit_iterator& operator++ () { if(++bit_ == 8) { bit_ = 0; ++it_; } return *this; }
+        bit_iterator operator++ (int) { auto tmp = *this; operator++(); return tmp; }
+        bool operator* () const
+        {
+            auto byte = static_cast<unsigned char>(*it_);
+            return (Order == bit_order::msb_first ? byte >> (7 - bit_) : byte >> bit_) & 1;
+        }
+
+        bool operator== (const bit_iterator& other) const { return it_ == other.it_ && bit_ == other.bit_; }
+        bool operator!= (const bit_iterator& other) const { return !operator==(other); }
+
+        I get() const { return it_; }
+        unsigned bit() const { return bit_; }
     };
 
+    // bit range of byte container
+    template<bit_order Order = bit_order::msb_first, class T>
+    auto bit_range(const T& s)
+    {
+        using I = bit_iterator<decltype(std::begin(s)), Order>;
+        return it_pair<I>(I(std::begin(s)), I(std::end(s)));
+    }
 }
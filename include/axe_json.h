@@ -0,0 +1,944 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include "axe_trait.h"
+#include "axe_result.h"
+#include "axe_exception.h"
+#include "axe_iterator.h"
+#include "axe_binary.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AXE_JSON_SSE2 1
+#include <emmintrin.h>
+#else
+#define AXE_JSON_SSE2 0
+#endif
+
+namespace axe
+{
+    namespace detail
+    {
+        // state carried between 64 byte blocks
+        struct json_scan_state
+        {
+            uint64_t prev_escaped = 0;
+            uint64_t prev_in_string = 0;
+        };
+
+        // masks of characters in 64 byte block, bit i stands for byte i
+        struct json_block
+        {
+            uint64_t quote = 0;
+            uint64_t backslash = 0;
+            uint64_t op = 0; // {}[]:,
+            uint64_t control = 0; // characters below 0x20
+        };
+
+        inline json_block json_classify(const char* p)
+        {
+            json_block b;
+#if AXE_JSON_SSE2
+            // '[' and '{', ']' and '}' differ only in 0x20 bit
+            const auto case_bit = _mm_set1_epi8(0x20);
+            const auto max_control = _mm_set1_epi8(0x1f);
+            for(unsigned k = 0; k < 4; ++k)
+            {
+                auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k * 16));
+                auto lower = _mm_or_si128(v, case_bit);
+                auto op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')), _mm_cmpeq_epi8(v, _mm_set1_epi8(':'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))));
+                b.quote |= uint64_t(unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))))) << (k * 16);
+                b.backslash |= uint64_t(unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))))) << (k * 16);
+                b.op |= uint64_t(unsigned(_mm_movemask_epi8(op))) << (k * 16);
+                b.control |= uint64_t(unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, max_control), max_control)))) << (k * 16);
+            }
+#else
+            for(unsigned k = 0; k < 8; ++k)
+            {
+                uint64_t w = load_le64(p + k * 8);
+                uint64_t lower = w | 0x2020202020202020ull;
+                b.quote |= swar_movemask(swar_equal(w, '"')) << (k * 8);
+                b.backslash |= swar_movemask(swar_equal(w, '\\')) << (k * 8);
+                b.op |= swar_movemask(swar_equal(w, ',') | swar_equal(w, ':')
+                    | swar_equal(lower, '{') | swar_equal(lower, '}')) << (k * 8);
+                b.control |= swar_movemask(swar_equal(w & 0xe0e0e0e0e0e0e0e0ull, 0)) << (k * 8);
+            }
+#endif
+            return b;
+        }
+
+        // returns mask of structural characters outside of strings and unescaped quotes in 64 byte block,
+        // escapes receives mask of backslashes and control characters inside strings
+        inline uint64_t json_structurals(const char* p, json_scan_state& state, uint64_t& escapes)
+        {
+            auto b = json_classify(p);
+
+            // escaped characters follow odd length sequences of backslashes,
+            // sequences starting on odd bits are separated by carry propagation
+            constexpr uint64_t even_bits = 0x5555555555555555ull;
+            uint64_t backslash = b.backslash & ~state.prev_escaped;
+            uint64_t follows_escape = backslash << 1 | state.prev_escaped;
+            uint64_t odd_starts = backslash & ~even_bits & ~follows_escape;
+            uint64_t even_starts = odd_starts + backslash;
+            state.prev_escaped = even_starts < odd_starts;
+            uint64_t escaped = (even_bits ^ (even_starts << 1)) & follows_escape;
+            uint64_t quote = b.quote & ~escaped;
+
+            // string characters (with opening quote) are found by prefix xor of quotes
+            uint64_t in_string = prefix_xor(quote) ^ state.prev_in_string;
+            state.prev_in_string = 0 - (in_string >> 63);
+            escapes = (b.backslash | b.control) & in_string;
+            return (b.op & ~in_string) | quote;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// json_index is the structural index of JSON text: bitmaps of quotes and
+    /// structural characters ({}[]:,) outside of strings, and of backslashes and
+    /// control characters inside strings; the text is classified in 64 byte blocks
+    /// (SSE2 or 8 byte words) without per byte branching, the index takes a quarter
+    /// of the text size; json rules navigate the index instead of scanning the text,
+    /// the text must outlive the index
+    //-------------------------------------------------------------------------
+    class json_index
+    {
+        const char* begin_ = nullptr;
+        const char* end_ = nullptr;
+        std::unique_ptr<uint64_t[]> bits_; // structural bitmap followed by escape bitmap, written once
+        size_t words_ = 0;
+        size_t capacity_ = 0;
+
+        const uint64_t* escapes() const { return bits_.get() + words_; }
+
+    public:
+        json_index() = default;
+        json_index(const char* begin, const char* end) { assign(begin, end); }
+        explicit json_index(std::string_view text) { assign(text.data(), text.data() + text.size()); }
+
+        /// indexes new text, memory of the index is reused
+        void assign(const char* begin, const char* end)
+        {
+            begin_ = begin;
+            end_ = end;
+            words_ = (end - begin + 63) / 64;
+            if(words_ * 2 > capacity_)
+            {
+                bits_.reset(new uint64_t[words_ * 2]);
+                capacity_ = words_ * 2;
+            }
+
+            auto structurals = bits_.get();
+            auto escapes = structurals + words_;
+            detail::json_scan_state state;
+            auto p = begin;
+            for(size_t k = 0; end - p >= 64; ++k, p += 64)
+                structurals[k] = detail::json_structurals(p, state, escapes[k]);
+
+            if(p != end)
+            {
+                char block[64];
+                std::memset(block, ' ', sizeof(block));
+                std::memcpy(block, p, end - p);
+                structurals[words_ - 1] = detail::json_structurals(block, state, escapes[words_ - 1]);
+            }
+        }
+
+        const char* begin() const { return begin_; }
+        const char* end() const { return end_; }
+
+        /// range [p, e) is a part of indexed text, rules fail on other text
+        bool contains(const char* p, const char* e) const
+        {
+            return std::less_equal<const char*>()(begin_, p) && std::less_equal<const char*>()(p, e)
+                && std::less_equal<const char*>()(e, end_);
+        }
+
+        /// character at p is a quote or structural character outside of strings
+        bool indexed(const char* p) const
+        {
+            auto offset = size_t(p - begin_);
+            return p != end_ && (bits_[offset / 64] >> (offset % 64) & 1);
+        }
+
+        /// the first indexed character at or after p, end() if there is none
+        const char* next(const char* p) const
+        {
+            auto offset = size_t(p - begin_);
+            auto k = offset / 64;
+            if(k >= words_)
+                return end_;
+
+            auto w = bits_[k] & (~uint64_t(0) << (offset % 64));
+            while(!w)
+            {
+                if(++k == words_)
+                    return end_;
+                w = bits_[k];
+            }
+            return begin_ + k * 64 + detail::count_trailing_zeros(w);
+        }
+
+        /// the position after the bracket closing the one at p, nullptr if brackets are not balanced;
+        /// brackets are only counted, the caller checks the closing bracket
+        const char* skip_brackets(const char* p) const
+        {
+            auto offset = size_t(p - begin_);
+            auto k = offset / 64;
+            auto w = bits_[k] & (~uint64_t(0) << (offset % 64));
+            for(ptrdiff_t depth = 0;;)
+            {
+                for(; w; w &= w - 1)
+                {
+                    auto q = begin_ + k * 64 + detail::count_trailing_zeros(w);
+                    auto c = *q | 0x20;
+                    depth += (c == '{') - (c == '}');
+                    if(depth == 0)
+                        return q + 1;
+                }
+                if(++k == words_)
+                    return nullptr;
+                w = bits_[k];
+            }
+        }
+
+        /// string characters in [p, e) have no backslashes and control characters
+        bool plain(const char* p, const char* e) const
+        {
+            if(p == e)
+                return true;
+
+            auto first = size_t(p - begin_), last = size_t(e - begin_) - 1;
+            auto k = first / 64, k_last = last / 64;
+            auto w = escapes()[k] & (~uint64_t(0) << (first % 64));
+            for(; k != k_last; w = escapes()[++k])
+            {
+                if(w)
+                    return false;
+            }
+            return !(w & (~uint64_t(0) >> (63 - last % 64)));
+        }
+    };
+
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // json_walker matches JSON values in indexed text, strings and containers are
+        // delimited by the index, only scalars and (when validating) strings with escapes are scanned;
+        // without validation containers are skipped by counting brackets in the index
+        //-------------------------------------------------------------------------
+        class json_walker
+        {
+            static constexpr unsigned max_depth = 1024;
+            const json_index& idx_;
+            const char* end_;
+            bool validate_;
+
+            bool at(const char* p) const { return p < end_ && idx_.indexed(p); }
+
+            static bool hex(char c) { return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f'); }
+
+            static bool valid_string(const char* p, const char* e)
+            {
+                constexpr uint64_t ones = 0x0101010101010101ull;
+                while(p != e)
+                {
+                    if(e - p >= 8)
+                    {   // no control characters and escapes in 8 bytes
+                        uint64_t w;
+                        std::memcpy(&w, p, sizeof(w));
+                        if(!(((w - ones * 0x20) & ~w & ones * 0x80) | swar_equal(w, '\\')))
+                        {
+                            p += 8;
+                            continue;
+                        }
+                    }
+
+                    auto c = static_cast<unsigned char>(*p++);
+                    if(c < 0x20)
+                        return false;
+                    if(c == '\\')
+                    {
+                        if(p == e)
+                            return false;
+
+                        switch(*p++)
+                        {
+                        case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                            break;
+                        case 'u':
+                            if(e - p < 4 || !hex(p[0]) || !hex(p[1]) || !hex(p[2]) || !hex(p[3]))
+                                return false;
+                            p += 4;
+                            break;
+                        default:
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
+
+            const char* digits(const char* p) const
+            {
+                auto q = p;
+                for(; q != end_ && *q >= '0' && *q <= '9'; ++q);
+                return q != p ? q : nullptr;
+            }
+
+            const char* number(const char* p) const
+            {
+                if(*p == '-' && ++p == end_)
+                    return nullptr;
+
+                if(*p == '0')
+                    ++p;
+                else if(*p < '1' || *p > '9' || !(p = digits(p)))
+                    return nullptr;
+
+                if(p != end_ && *p == '.' && !(p = digits(p + 1)))
+                    return nullptr;
+
+                if(p != end_ && (*p | 0x20) == 'e')
+                {
+                    if(++p != end_ && (*p == '+' || *p == '-'))
+                        ++p;
+                    p = digits(p);
+                }
+                return p;
+            }
+
+            const char* literal(const char* p, std::string_view s) const
+            {
+                return size_t(end_ - p) >= s.size() && std::memcmp(p, s.data(), s.size()) == 0 ? p + s.size() : nullptr;
+            }
+
+            // skips container by counting brackets in the index
+            const char* skip_container(const char* p) const
+            {
+                auto q = idx_.skip_brackets(p);
+                return q && q <= end_ && q[-1] == (*p == '{' ? '}' : ']') ? q : nullptr;
+            }
+
+            const char* container(const char* p, unsigned depth)
+            {
+                if(!validate_)
+                    return skip_container(p);
+
+                if(depth == max_depth)
+                    return nullptr;
+
+                char close = *p == '{' ? '}' : ']';
+                p = skip_ws(p + 1);
+                if(at(p) && *p == close)
+                    return p + 1;
+
+                for(;;)
+                {
+                    if(close == '}')
+                    {
+                        if(p == end_ || *p != '"' || !(p = string(p)))
+                            return nullptr;
+
+                        p = skip_ws(p);
+                        if(!at(p) || *p != ':')
+                            return nullptr;
+
+                        p = skip_ws(p + 1);
+                    }
+
+                    if(!(p = value(p, depth + 1)))
+                        return nullptr;
+
+                    p = skip_ws(p);
+                    if(!at(p))
+                        return nullptr;
+
+                    if(*p == close)
+                        return p + 1;
+                    if(*p != ',')
+                        return nullptr;
+
+                    p = skip_ws(p + 1);
+                }
+            }
+
+        public:
+            json_walker(const json_index& idx, const char* end, bool validate)
+                : idx_(idx), end_(end), validate_(validate)
+            {
+                assert(end <= idx.end());
+            }
+
+            const char* skip_ws(const char* p) const
+            {
+                for(; p != end_ && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'); ++p);
+                return p;
+            }
+
+            // matches string at p, returns the position after closing quote
+            const char* string(const char* p) const
+            {
+                if(!at(p))
+                    return nullptr;
+
+                auto close = idx_.next(p + 1);
+                if(close >= end_ || (validate_ && !idx_.plain(p + 1, close) && !valid_string(p + 1, close)))
+                    return nullptr;
+
+                return close + 1;
+            }
+
+            // matches value at p, returns its end or nullptr
+            const char* value(const char* p, unsigned depth = 0)
+            {
+                if(p == end_)
+                    return nullptr;
+
+                switch(*p)
+                {
+                case '"':
+                    return string(p);
+                case '{': case '[':
+                    return at(p) ? container(p, depth) : nullptr;
+                case 't':
+                    return literal(p, "true");
+                case 'f':
+                    return literal(p, "false");
+                case 'n':
+                    return literal(p, "null");
+                default:
+                    return number(p);
+                }
+            }
+
+            // matches the separator after value in container, returns the position after it;
+            // c is the separator found (',' or closing bracket) or 0
+            const char* separator(const char* p, char& c) const
+            {
+                p = skip_ws(p);
+                c = 0;
+                if(!at(p))
+                    return nullptr;
+
+                c = *p;
+                return p + 1;
+            }
+
+            bool at_structural(const char* p, char c) const { return at(p) && *p == c; }
+        };
+
+        // contiguous input of indexed text
+        template<class I, class I2>
+        void json_check_iterators()
+        {
+            static_assert(is_contiguous_iterator<I> && std::is_same_v<I, I2>
+                && std::is_same_v<std::remove_cv_t<typename std::iterator_traits<I>::value_type>, char>,
+                "json rules require contiguous char input of indexed text");
+        }
+
+        template<class I>
+        const char* json_pointer(I i) { return &*i; }
+
+        inline const char* json_pointer(const char* p) { return p; }
+        inline const char* json_pointer(char* p) { return p; }
+    }
+
+    //-------------------------------------------------------------------------
+    /// type of JSON value matched by r_json_t
+    //-------------------------------------------------------------------------
+    enum class json_type { any, object, array, string, number, boolean, null };
+
+    //-------------------------------------------------------------------------
+    /// r_json_t matches validated JSON value of specified type in indexed text,
+    /// the value must start at the first position (no leading whitespace)
+    //-------------------------------------------------------------------------
+    class r_json_t final
+    {
+        const json_index& idx_;
+        json_type type_;
+
+        bool check_type(char c) const
+        {
+            switch(type_)
+            {
+            case json_type::object: return c == '{';
+            case json_type::array: return c == '[';
+            case json_type::string: return c == '"';
+            case json_type::number: return c == '-' || (c >= '0' && c <= '9');
+            case json_type::boolean: return c == 't' || c == 'f';
+            case json_type::null: return c == 'n';
+            default: return true;
+            }
+        }
+
+    public:
+        r_json_t(const json_index& idx, json_type type) : idx_(idx), type_(type) {}
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            detail::json_check_iterators<Iterator, Iterator2>();
+            if(i1 == i2)
+                return make_result(false, i1);
+
+            auto p = detail::json_pointer(i1);
+            if(!idx_.contains(p, p + (i2 - i1)) || !check_type(*p))
+                return make_result(false, i1);
+
+            detail::json_walker w(idx_, p + (i2 - i1), true);
+            auto q = w.value(p);
+            return q ? make_result(true, i1 + (q - p)) : make_result(false, i1);
+        }
+
+        const char* name() const { return "r_json"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// json_value, json_object, json_array, json_string, json_number, json_boolean and json_null
+    /// create rules matching validated JSON values in text indexed by idx,
+    /// extractors receive the text of matched value, e.g. json_string(idx) >> str
+    //-------------------------------------------------------------------------
+    inline r_json_t json_value(const json_index& idx) { return r_json_t(idx, json_type::any); }
+    inline r_json_t json_object(const json_index& idx) { return r_json_t(idx, json_type::object); }
+    inline r_json_t json_array(const json_index& idx) { return r_json_t(idx, json_type::array); }
+    inline r_json_t json_string(const json_index& idx) { return r_json_t(idx, json_type::string); }
+    inline r_json_t json_number(const json_index& idx) { return r_json_t(idx, json_type::number); }
+    inline r_json_t json_boolean(const json_index& idx) { return r_json_t(idx, json_type::boolean); }
+    inline r_json_t json_null(const json_index& idx) { return r_json_t(idx, json_type::null); }
+
+    //-------------------------------------------------------------------------
+    /// r_json_members_t matches JSON object with member keys, the object is walked once
+    /// and rules Rs are then matched in listed order on the values of the first members
+    /// with these keys, each rule must consume its value entirely; other members are skipped
+    /// by the index, their containers are checked only for balanced brackets
+    //-------------------------------------------------------------------------
+    template<class... Rs>
+    class r_json_members_t final
+    {
+        static constexpr size_t size = sizeof...(Rs);
+        const json_index& idx_;
+        std::array<std::string, size> keys_;
+        std::tuple<Rs...> rs_;
+
+    public:
+        template<class... RR>
+        r_json_members_t(const json_index& idx, std::array<std::string, size> keys, RR&&... rs)
+            : idx_(idx), keys_(std::move(keys)), rs_(std::forward<RR>(rs)...) {}
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            detail::json_check_iterators<Iterator, Iterator2>();
+            if(i1 == i2)
+                return make_result(false, i1);
+
+            auto p = detail::json_pointer(i1);
+            auto begin = p;
+            if(!idx_.contains(p, p + (i2 - i1)))
+                return make_result(false, i1);
+
+            detail::json_walker w(idx_, p + (i2 - i1), false);
+            if(!w.at_structural(p, '{'))
+                return make_result(false, i1);
+
+            p = w.skip_ws(p + 1);
+            std::array<std::pair<const char*, const char*>, size> values{};
+            size_t found = 0;
+            char c = ',';
+            while(c == ',')
+            {
+                auto key = p;
+                if(!(p = w.string(p)))
+                    return make_result(false, i1);
+
+                auto k = size;
+                if(found != size)
+                {
+                    std::string_view name(key + 1, p - key - 2);
+                    for(k = 0; k < size && (values[k].first || keys_[k] != name); ++k);
+                }
+
+                p = w.skip_ws(p);
+                if(!w.at_structural(p, ':'))
+                    return make_result(false, i1);
+
+                auto v = w.skip_ws(p + 1);
+                if(!(p = w.value(v)))
+                    return make_result(false, i1);
+
+                if(k != size)
+                {
+                    values[k] = std::make_pair(v, p);
+                    ++found;
+                }
+
+                if(!(p = w.separator(p, c)))
+                    return make_result(false, i1);
+
+                if(c == ',')
+                    p = w.skip_ws(p);
+            }
+
+            if(found != size || c != '}')
+                return make_result(false, i1);
+
+            size_t k = 0;
+            auto match_value = [&](const auto& r)
+            {
+                auto [v1, v2] = values[k++];
+                auto res = r(i1 + (v1 - begin), i1 + (v2 - begin));
+                return res.matched && res.position == i1 + (v2 - begin);
+            };
+            bool matched = std::apply([&](const auto&... r) { return (match_value(r) && ...); }, rs_);
+            return matched ? make_result(true, i1 + (p - begin)) : make_result(false, i1);
+        }
+
+        const char* name() const { return "r_json_members"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// r_json_elements_t matches JSON array, the rule R is matched on each element
+    /// and must consume it entirely
+    //-------------------------------------------------------------------------
+    template<class R>
+    class r_json_elements_t final
+    {
+        const json_index& idx_;
+        R r_;
+
+    public:
+        template<class RR>
+        r_json_elements_t(const json_index& idx, RR&& r) : idx_(idx), r_(std::forward<RR>(r)) {}
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            detail::json_check_iterators<Iterator, Iterator2>();
+            if(i1 == i2)
+                return make_result(false, i1);
+
+            auto p = detail::json_pointer(i1);
+            auto begin = p;
+            if(!idx_.contains(p, p + (i2 - i1)))
+                return make_result(false, i1);
+
+            detail::json_walker w(idx_, p + (i2 - i1), false);
+            if(!w.at_structural(p, '['))
+                return make_result(false, i1);
+
+            p = w.skip_ws(p + 1);
+            if(w.at_structural(p, ']'))
+                return make_result(true, i1 + (p + 1 - begin));
+
+            char c = ',';
+            while(c == ',')
+            {
+                auto v = p;
+                if(!(p = w.value(v)))
+                    return make_result(false, i1);
+
+                auto res = r_(i1 + (v - begin), i1 + (p - begin));
+                if(!res.matched || res.position != i1 + (p - begin))
+                    return make_result(false, i1);
+
+                if(!(p = w.separator(p, c)))
+                    return make_result(false, i1);
+
+                if(c == ',')
+                    p = w.skip_ws(p);
+            }
+
+            return c == ']' ? make_result(true, i1 + (p - begin)) : make_result(false, i1);
+        }
+
+        const char* name() const { return "r_json_elements"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// json_member creates a rule matching object member value, e.g.
+    /// json_member(idx, "price", r_double(price)), json_member(idx, "id", json_member(idx, "name", r))
+    //-------------------------------------------------------------------------
+    template<class R>
+    auto json_member(const json_index& idx, std::string key, R&& r)
+    {
+        static_assert(is_rule_v<R>, "R must be a rule");
+        return r_json_members_t<std::decay_t<R>>(idx, { std::move(key) }, std::forward<R>(r));
+    }
+
+    //-------------------------------------------------------------------------
+    /// json_members creates a rule matching values of several members of the same object
+    /// in one pass, keys are paired with rules in order, e.g.
+    /// json_members(idx, { "id", "name" }, r_decimal(id), json_string(idx) >> name)
+    //-------------------------------------------------------------------------
+    template<size_t N, class... R>
+    auto json_members(const json_index& idx, const char* const (&keys)[N], R&&... r)
+    {
+        static_assert(N == sizeof...(R), "each key requires a rule");
+        static_assert((is_rule_v<R> && ...), "R must be a rule");
+        std::array<std::string, N> names;
+        std::copy(std::begin(keys), std::end(keys), names.begin());
+        return r_json_members_t<std::decay_t<R>...>(idx, std::move(names), std::forward<R>(r)...);
+    }
+
+    //-------------------------------------------------------------------------
+    /// json_array creates a rule matching array elements, e.g.
+    /// json_array(idx, json_string(idx) >> [&](auto i1, auto i2) { tags.emplace_back(i1, i2); })
+    //-------------------------------------------------------------------------
+    template<class R>
+    auto json_array(const json_index& idx, R&& r)
+    {
+        static_assert(is_rule_v<R>, "R must be a rule");
+        return r_json_elements_t<std::decay_t<R>>(idx, std::forward<R>(r));
+    }
+
+    namespace detail
+    {
+        // reads 4 hex digits following i, on success i is moved to the last digit
+        template<class I>
+        long json_hex4(I& i, I i2)
+        {
+            long code = 0;
+            auto j = i;
+            for(int n = 0; n < 4; ++n)
+            {
+                if(++j == i2)
+                    return -1;
+
+                auto c = *j | 0x20;
+                if(*j >= '0' && *j <= '9')
+                    code = code * 16 + (*j - '0');
+                else if(c >= 'a' && c <= 'f')
+                    code = code * 16 + (c - 'a' + 10);
+                else
+                    return -1;
+            }
+            i = j;
+            return code;
+        }
+
+        inline void json_append_utf8(std::string& s, unsigned long code)
+        {
+            if(code < 0x80)
+                s.push_back(char(code));
+            else if(code < 0x800)
+            {
+                s.push_back(char(0xc0 | code >> 6));
+                s.push_back(char(0x80 | (code & 0x3f)));
+            }
+            else if(code < 0x10000)
+            {
+                s.push_back(char(0xe0 | code >> 12));
+                s.push_back(char(0x80 | (code >> 6 & 0x3f)));
+                s.push_back(char(0x80 | (code & 0x3f)));
+            }
+            else
+            {
+                s.push_back(char(0xf0 | code >> 18));
+                s.push_back(char(0x80 | (code >> 12 & 0x3f)));
+                s.push_back(char(0x80 | (code >> 6 & 0x3f)));
+                s.push_back(char(0x80 | (code & 0x3f)));
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// json_unescape returns the value of JSON string matched by json_string, quotes are removed
+    /// and escapes decoded, unicode escapes are converted to UTF-8 and unpaired surrogates to U+FFFD;
+    /// the string is assumed valid, malformed escapes are copied without backslash
+    //-------------------------------------------------------------------------
+    template<class I>
+    std::string json_unescape(I i1, I i2)
+    {
+        std::string s;
+        if(i1 != i2 && *i1 == '"')
+            ++i1;
+
+        for(; i1 != i2 && *i1 != '"'; ++i1)
+        {
+            if(*i1 != '\\' || std::next(i1) == i2)
+            {
+                s.push_back(*i1);
+                continue;
+            }
+
+            switch(*++i1)
+            {
+            case 'b': s.push_back('\b'); break;
+            case 'f': s.push_back('\f'); break;
+            case 'n': s.push_back('\n'); break;
+            case 'r': s.push_back('\r'); break;
+            case 't': s.push_back('\t'); break;
+            case 'u':
+            {
+                auto code = detail::json_hex4(i1, i2);
+                if(code < 0)
+                {
+                    s.push_back('u');
+                    break;
+                }
+
+                if(code >= 0xd800 && code < 0xe000)
+                {   // high surrogate must be followed by escaped low surrogate
+                    auto j = i1;
+                    long low = -1;
+                    if(code < 0xdc00 && ++j != i2 && *j == '\\' && ++j != i2 && *j == 'u')
+                        low = detail::json_hex4(j, i2);
+
+                    if(low >= 0xdc00 && low < 0xe000)
+                    {
+                        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                        i1 = j;
+                    }
+                    else
+                        code = 0xfffd;
+                }
+                detail::json_append_utf8(s, code);
+                break;
+            }
+            default: // quote, backslash, slash
+                s.push_back(*i1);
+            }
+        }
+        return s;
+    }
+
+    //-------------------------------------------------------------------------
+    /// ndjson_parser matches newline delimited JSON records arriving in chunks, complete lines
+    /// are indexed in one pass and the record rule is matched at the first non blank character
+    /// of each line, the rest of the line must be blank; matched records are passed
+    /// to sink(it_pair<const char*>), the record rule is built on the index passed to constructor
+    //-------------------------------------------------------------------------
+    template<class R, class Sink>
+    class ndjson_parser
+    {
+        json_index& idx_;
+        R r_;
+        Sink sink_;
+        std::string buffer_;
+        size_t consumed_ = 0; // total length of matched lines
+        bool failed_ = false;
+
+        static bool blank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+        // matches complete lines in buffer, last is true when no more data will arrive;
+        // buffered data before offset 'from' has no line end, only the new chunk is searched
+        bool match(bool last, size_t from = 0)
+        {
+            const char* begin = buffer_.data();
+            const char* end = begin + buffer_.size();
+            if(!last)
+            {
+                for(; end != begin + from && end[-1] != '\n'; --end);
+                if(end == begin + from)
+                    return true;
+            }
+
+            idx_.assign(begin, end);
+            auto p = begin;
+            while(p != end)
+            {
+                auto line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                line_end = line_end ? line_end + 1 : end;
+                auto first = std::find_if_not(p, line_end, blank);
+                if(first != line_end)
+                {
+                    auto res = r_(first, line_end);
+                    if(!res.matched || res.position == first || !std::all_of(res.position, line_end, blank))
+                    {
+                        failed_ = true;
+                        break;
+                    }
+
+                    std::invoke(sink_, it_pair<const char*>(first, res.position));
+                }
+
+                consumed_ += line_end - p;
+                p = line_end;
+            }
+
+            buffer_.erase(0, p - begin);
+            return !failed_;
+        }
+
+    public:
+        template<class RR, class SS>
+        ndjson_parser(json_index& idx, RR&& r, SS&& sink) : idx_(idx), r_(std::forward<RR>(r)), sink_(std::forward<SS>(sink)) {}
+
+        ndjson_parser(const ndjson_parser&) = delete;
+        ndjson_parser& operator= (const ndjson_parser&) = delete;
+
+        /// appends chunk and matches complete lines, returns false if parsing failed
+        bool push(std::string_view chunk)
+        {
+            if(failed_)
+                return false;
+            auto from = buffer_.size();
+            buffer_.append(chunk.data(), chunk.size());
+            return match(false, from);
+        }
+
+        /// matches the last line at the end of stream, returns true if all data matched
+        bool finish()
+        {
+            return !failed_ && match(true) && buffer_.empty();
+        }
+
+        bool failed() const { return failed_; }
+
+        /// offset of the first unmatched line in the stream
+        size_t consumed() const { return consumed_; }
+
+        /// number of buffered characters of incomplete line
+        size_t buffered() const { return buffer_.size(); }
+    };
+
+    //-------------------------------------------------------------------------
+    /// function make_ndjson_parser creates ndjson_parser for records matched by rule r
+    /// built on index idx, e.g. make_ndjson_parser(idx, json_member(idx, "id", r_decimal(id)), sink)
+    //-------------------------------------------------------------------------
+    template<class R, class Sink>
+    inline ndjson_parser<std::decay_t<R>, std::decay_t<Sink>> make_ndjson_parser(json_index& idx, R&& r, Sink&& sink)
+    {
+        return ndjson_parser<std::decay_t<R>, std::decay_t<Sink>>(idx, std::forward<R>(r), std::forward<Sink>(sink));
+    }
+}
@@ -0,0 +1,121 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <utility>
+#include "axe_trait.h"
+#include "axe_result.h"
+#include "axe_iterator.h"
+#include "axe_detail.h"
+#include "axe_dfa.h"
+
+namespace axe
+{
+    //-------------------------------------------------------------------------
+    /// token produced by lexer, offsets are relative to the beginning of lexed text
+    /// token converts to its kind, so r_char(kind) and r_pred rules can match tokens
+    /// extractors on token rules should be generic lambdas returning void
+    //-------------------------------------------------------------------------
+    struct token
+    {
+        int kind;
+        size_t begin;
+        size_t end;
+
+        operator int() const { return kind; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// lexer compiles regular token rules into a single maximal-munch dfa
+    /// token kind is the position of the rule in constructor arguments,
+    /// when several rules match the longest text the first rule wins
+    //-------------------------------------------------------------------------
+    class lexer
+    {
+        detail::dfa dfa_;
+        std::vector<bool> skip_;
+
+    public:
+        template<class R, class... Rs, class = detail::disable_copy<lexer, R>>
+        explicit lexer(const R& r, const Rs&... rs)
+            : dfa_(detail::make_dfa(r, rs...)), skip_(1 + sizeof...(Rs))
+        {
+        }
+
+        /// tokens of specified kind (e.g. white spaces) are matched, but not written
+        lexer& skip(int kind)
+        {
+            skip_.at(kind) = true;
+            return *this;
+        }
+
+        /// appends tokens to the vector, returns position where lexing stopped
+        /// result is matched when the whole text is split to tokens
+        template<class Iterator, class Iterator2>
+        result<Iterator> tokenize(Iterator i1, Iterator2 i2, std::vector<token>& tokens) const
+        {
+            static_assert(is_forward_iterator<Iterator>);
+            size_t offset = 0;
+
+            while(i1 != i2)
+            {
+                auto [kind, i] = dfa_.longest_match(i1, i2);
+                if(kind < 0 || i == i1)
+                    return result(false, i1);
+
+                auto length = static_cast<size_t>(std::distance(i1, i));
+                if(!skip_[kind])
+                    tokens.push_back(token{ kind, offset, offset + length });
+
+                offset += length;
+                i1 = i;
+            }
+
+            return result(true, i1);
+        }
+
+        template<class Txt>
+        auto tokenize(const Txt& txt, std::vector<token>& tokens) const
+        {
+            return tokenize(std::begin(txt), std::end(txt), tokens);
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    /// make_it_pair converts token to it_pair, base is the beginning of lexed text
+    //-------------------------------------------------------------------------
+    template<class I>
+    auto make_it_pair(const token& t, I base)
+    {
+        return it_pair<I>(std::next(base, t.begin), std::next(base, t.end));
+    }
+}
@@ -33,6 +33,7 @@
 #include "axe_extractor_function.h"
 #include "axe_predicate.h"
 #include "axe_trait.h"
+#include "axe_context.h"
 
 namespace axe
 {
@@ -60,15 +61,15 @@ namespace axe
     template<class T, unsigned base>
     struct r_number_w_base_t<T, base, false> 
     {
-        T& number_;
+        detail::binding<T> number_;
     public:
-        explicit r_number_w_base_t(T& number) : number_(number) {}
+        explicit r_number_w_base_t(detail::binding<T> number) : number_(number) {}
 
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
         {
             auto matched = false;
-            T number{ 0 };
+            detail::bound_t<T> number{ 0 };
 
             for(; i1 != i2 && radix<base>::match(*i1); ++i1)
             {
@@ -77,7 +78,7 @@ namespace axe
             }
 
             if(matched)
-                number_ = number;
+                number_.get() = number;
 
             return make_result(matched, i1);
         }
@@ -100,9 +101,9 @@ namespace axe
     template<class T, unsigned base>
     struct r_number_w_base_t<T, base, true> 
     {
-        T& number_;
+        detail::binding<T> number_;
     public:
-        explicit r_number_w_base_t(T& number) : number_(number) {}
+        explicit r_number_w_base_t(detail::binding<T> number) : number_(number) {}
 
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
@@ -124,10 +125,11 @@ namespace axe
 
             for(; i1 != i2 && is_space()(*i1); ++i1); // skip spaces
 
-            auto result = r_number_w_base_t<T, base, false>(number_)(i1, i2);
+            auto& number = number_.get();
+            auto result = r_number_w_base_t<detail::bound_t<T>, base, false>(number)(i1, i2);
 
             if(result.matched && sign)
-                number_ = -number_;
+                number = -number;
 
             return result;
         }
@@ -168,14 +170,14 @@ namespace axe
     template<class T>
     class r_hex_t 
     {
-        T& number_;
+        detail::binding<T> number_;
     public:
-        explicit r_hex_t(T& number) : number_(number) {}
+        explicit r_hex_t(detail::binding<T> number) : number_(number) {}
 
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
         {
-            T number{ 0 };
+            detail::bound_t<T> number{ 0 };
             auto start = i1;
 
             for(; i1 != i2 && is_hex()(*i1); ++i1)
@@ -185,13 +187,13 @@ namespace axe
 
             auto matched = i1 != start;
             if(matched)
-                number_ = number;
+                number_.get() = number;
 
             return make_result(matched, i1);
         }
     private:
         template<class Iterator>
-        static T convert(Iterator i)
+        static detail::bound_t<T> convert(Iterator i)
         {
             return *i >= '0' && *i <= '9' ? *i - '0'
                 : *i >= 'A' && *i <= 'F' ? *i - 'A' + 10
@@ -205,14 +207,14 @@ namespace axe
     template<class T>
     class r_oct_t 
     {
-        T& number_;
+        detail::binding<T> number_;
     public:
-        explicit r_oct_t(T& number) : number_(number) {}
+        explicit r_oct_t(detail::binding<T> number) : number_(number) {}
 
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
         {
-            T number{ 0 };
+            detail::bound_t<T> number{ 0 };
             auto start = i1;
 
             for(; i1 != i2 && is_oct()(*i1); ++i1)
@@ -223,7 +225,7 @@ namespace axe
             auto matched = i1 != start;
 
             if(matched)
-                number_ = number;
+                number_.get() = number;
 
             return make_result(matched, i1);
         }
@@ -235,14 +237,14 @@ namespace axe
     template<class T>
     class r_binary_t 
     {
-        T& number_;
+        detail::binding<T> number_;
     public:
-        explicit r_binary_t(T& number) : number_(number) {}
+        explicit r_binary_t(detail::binding<T> number) : number_(number) {}
 
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
         {
-            T number{ 0 };
+            detail::bound_t<T> number{ 0 };
             auto start = i1;
 
             for(; i1 != i2 && is_bin()(*i1); ++i1)
@@ -252,7 +254,7 @@ namespace axe
 
             auto matched = i1 != start;
             if(matched)
-                number_ = number;
+                number_.get() = number;
 
             return make_result(matched, i1);
         }
@@ -264,9 +266,9 @@ namespace axe
     template<class T = void>
     class r_ufixed_t 
     {
-        T& number_;
+        detail::binding<T> number_;
     public:
-        explicit r_ufixed_t(T& number) : number_(number) {}
+        explicit r_ufixed_t(detail::binding<T> number) : number_(number) {}
 
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
@@ -284,7 +286,8 @@ namespace axe
 
             if(result.matched)
             {
-                number_ = u1 + u2 / pow(T(10), T(length));
+                using value_type = detail::bound_t<T>;
+                number_.get() = u1 + u2 / pow(value_type(10), value_type(length));
             }
 
             return make_result(result.matched, result.position, i1);
@@ -314,25 +317,26 @@ namespace axe
     template<class T = void>
     class r_fixed_t 
     {
-        T&  number_;
+        detail::binding<T> number_;
     public:
 
-        explicit r_fixed_t(T& number) : number_(number) {}
+        explicit r_fixed_t(detail::binding<T> number) : number_(number) {}
 
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
         {
             char sign = 0;
+            auto& number = number_.get();
 
             auto result = // optional sign
                 (
                     ~(r_char<char>('-') >> sign | '+')
                     & ~r_predstr(is_space())
-                    & r_ufixed_t<T>(number_)
+                    & r_ufixed_t<detail::bound_t<T>>(number)
                     )(i1, i2);
 
             if(result.matched && sign == '-')
-                number_ *= -1;
+                number *= -1;
 
             return result;
         }
@@ -361,11 +365,11 @@ namespace axe
     template<class T = void>
     class r_double_t 
     {
-        T& d_;
+        detail::binding<T> d_;
 
     public:
 
-        explicit r_double_t(T& d) : d_(d) {}
+        explicit r_double_t(detail::binding<T> d) : d_(d) {}
 
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
@@ -389,7 +393,11 @@ namespace axe
                     )(i1, i2);
 
             if(result.matched)
-                d_ = (sign == '-' ? -1 : 1) * (T(i) + frac / pow(T(10), T(flen))) * pow(T(10), T(e));
+            {
+                using value_type = detail::bound_t<T>;
+                d_.get() = (sign == '-' ? -1 : 1) * (value_type(i) + frac / pow(value_type(10), value_type(flen)))
+                    * pow(value_type(10), value_type(e));
+            }
 
             return result;
         }
@@ -32,6 +32,7 @@
 
 namespace axe
 {
+    // numeric rules take either a variable reference or a slot of parse context (see axe_context.h)
 
     //-------------------------------------------------------------------------
     /// r_udecimal rule for matching unsigned decimal
@@ -39,6 +40,9 @@ namespace axe
     template<class T>
     inline r_udecimal_t<T> r_udecimal(T& t) { return r_udecimal_t<T>(t); }
 
+    template<class Ctx, class T>
+    inline r_udecimal_t<slot<Ctx, T>> r_udecimal(slot<Ctx, T> s) { return r_udecimal_t<slot<Ctx, T>>(s); }
+
     inline r_udecimal_t<> r_udecimal() { return r_udecimal_t<>(); }
 
     //-------------------------------------------------------------------------
@@ -47,6 +51,9 @@ namespace axe
     template<class T>
     inline r_decimal_t<T> r_decimal(T& t) { return r_decimal_t<T>(t); }
 
+    template<class Ctx, class T>
+    inline r_decimal_t<slot<Ctx, T>> r_decimal(slot<Ctx, T> s) { return r_decimal_t<slot<Ctx, T>>(s); }
+
     inline r_decimal_t<> r_decimal() { return r_decimal_t<>(); }
 
     //-------------------------------------------------------------------------
@@ -55,24 +62,36 @@ namespace axe
     template<class T>
     inline r_hex_t<T> r_hex(T& t) { return r_hex_t<T>(t); }
 
+    template<class Ctx, class T>
+    inline r_hex_t<slot<Ctx, T>> r_hex(slot<Ctx, T> s) { return r_hex_t<slot<Ctx, T>>(s); }
+
     //-------------------------------------------------------------------------
     /// r_hex rule for matching unsigned decimal in oct format
     //-------------------------------------------------------------------------
     template<class T>
     inline r_oct_t<T> r_oct(T& t) { return r_oct_t<T>(t); }
 
+    template<class Ctx, class T>
+    inline r_oct_t<slot<Ctx, T>> r_oct(slot<Ctx, T> s) { return r_oct_t<slot<Ctx, T>>(s); }
+
     //-------------------------------------------------------------------------
     /// r_hex rule for matching unsigned decimal in bin format
     //-------------------------------------------------------------------------
     template<class T>
     inline r_binary_t<T> r_binary(T& t) { return r_binary_t<T>(t); }
 
+    template<class Ctx, class T>
+    inline r_binary_t<slot<Ctx, T>> r_binary(slot<Ctx, T> s) { return r_binary_t<slot<Ctx, T>>(s); }
+
     //-------------------------------------------------------------------------
     /// r_ufixed rule for matching unsigned fixed point number
     //-------------------------------------------------------------------------
     template<class T>
     inline r_ufixed_t<T> r_ufixed(T& t) { return r_ufixed_t<T>(t); }
 
+    template<class Ctx, class T>
+    inline r_ufixed_t<slot<Ctx, T>> r_ufixed(slot<Ctx, T> s) { return r_ufixed_t<slot<Ctx, T>>(s); }
+
     inline r_ufixed_t<> r_ufixed() { return r_ufixed_t<>(); }
 
     //-------------------------------------------------------------------------
@@ -81,6 +100,9 @@ namespace axe
     template<class T>
     inline r_fixed_t<T> r_fixed(T& t) { return r_fixed_t<T>(t); }
 
+    template<class Ctx, class T>
+    inline r_fixed_t<slot<Ctx, T>> r_fixed(slot<Ctx, T> s) { return r_fixed_t<slot<Ctx, T>>(s); }
+
     inline r_fixed_t<> r_fixed() { return r_fixed_t<>(); }
 
     //-------------------------------------------------------------------------
@@ -89,5 +111,8 @@ namespace axe
     template<class T>
     inline r_double_t<T> r_double(T& d) { return r_double_t<T>(d); }
 
+    template<class Ctx, class T>
+    inline r_double_t<slot<Ctx, T>> r_double(slot<Ctx, T> s) { return r_double_t<slot<Ctx, T>>(s); }
+
     inline r_double_t<> r_double() { return r_double_t<>(); }
 }
@@ -0,0 +1,476 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <tuple>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include "axe_trait.h"
+#include "axe_terminal.h"
+#include "axe_composite.h"
+#include "axe_extractor.h"
+#include "axe_dfa.h"
+#include "axe_reflect.h"
+
+namespace axe
+{
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // pure rule contains no extractors and no opaque rules,
+        // so it can be evaluated fewer times or skipped without side effects
+        //-------------------------------------------------------------------------
+        template<class R, class Children = typename rule_traits_t<R>::children>
+        struct pure_rule;
+
+        template<class R, class... Cs>
+        struct pure_rule<R, std::tuple<Cs...>> : std::bool_constant<rule_kind_v<R> != rule_kind::extractor
+            && rule_kind_v<R> != rule_kind::other && (pure_rule<Cs>::value && ...)> {};
+
+        template<class R>
+        constexpr bool is_pure_rule_v = pure_rule<std::remove_cv_t<std::remove_reference_t<R>>>::value;
+
+        // byte tests are only valid for plain char input
+        template<class Iterator>
+        constexpr bool is_byte_input_v = is_forward_iterator<Iterator>
+            && std::is_same_v<std::decay_t<decltype(*std::declval<Iterator>())>, char>;
+
+        //-------------------------------------------------------------------------
+        /// predicate testing character class as a bitmap, other element types use the original rule
+        //-------------------------------------------------------------------------
+        template<class R>
+        class is_byte_class_t final
+        {
+            byte_set bytes_;
+            R r_;
+        public:
+            explicit is_byte_class_t(const R& r) : bytes_(class_rule<R>::get(r)), r_(r) {}
+
+            template<class V>
+            bool operator() (V v) const
+            {
+                if constexpr(std::is_same_v<V, char>)
+                    return bytes_[static_cast<unsigned char>(v)];
+                else
+                    return r_(&v, &v + 1).matched;
+            }
+        };
+
+        //-------------------------------------------------------------------------
+        // rule can match empty input before the end of input, unlike is_nullable
+        // it excludes r_end, so that _endl is not nullable in the middle of a line
+        //-------------------------------------------------------------------------
+        template<class R>
+        bool is_nullable_inside(const R& r)
+        {
+            constexpr auto kind = rule_kind_v<R>;
+            if constexpr(std::is_same_v<std::remove_cv_t<R>, r_end>)
+                return false;
+            else if constexpr(kind == rule_kind::sequence || kind == rule_kind::choice || kind == rule_kind::named
+                || kind == rule_kind::extractor || kind == rule_kind::reference)
+            {
+                bool all = true, any = false;
+                visit_children(r, [&](const auto& child)
+                {
+                    auto nullable = is_nullable_inside(child);
+                    all = all && nullable;
+                    any = any || nullable;
+                });
+                return kind == rule_kind::choice ? any : all;
+            }
+            else
+                return is_nullable(r);
+        }
+
+        //-------------------------------------------------------------------------
+        /// r_first_t fails without evaluating rule, which cannot start with the next byte
+        /// and cannot match empty input there
+        //-------------------------------------------------------------------------
+        template<class R>
+        class r_first_t final
+        {
+            R r_;
+            byte_set first_;
+            bool guard_;
+            bool empty_;
+        public:
+            template<class T, class = disable_copy<r_first_t<R>, T>>
+            explicit r_first_t(T&& r) : r_(std::forward<T>(r)), first_(first_set(r_)),
+                guard_(!is_nullable_inside(r_) && !first_.all()), empty_(is_nullable(r_)) {}
+
+            template<class Iterator, class Iterator2>
+            result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+            {
+                if constexpr(is_byte_input_v<Iterator>)
+                {
+                    if(i1 == i2 ? !empty_ : guard_ && !first_[static_cast<unsigned char>(*i1)])
+                        return make_result(false, i1);
+                }
+                return r_(i1, i2);
+            }
+
+            const R& rule() const { return r_; }
+        };
+
+        template<class R>
+        constexpr bool is_str_rule_v = false;
+
+        template<class CharT>
+        constexpr bool is_str_rule_v<r_str<CharT>> = true;
+
+        //-------------------------------------------------------------------------
+        // rules of the same type match the same way, if their values are the same;
+        // rules not known to reflection are reported as different
+        //-------------------------------------------------------------------------
+        template<class R>
+        bool same_rule(const R& r1, const R& r2)
+        {
+            constexpr auto kind = rule_kind_v<R>;
+            if constexpr(std::is_empty_v<R>)
+                return true;
+            else if constexpr(class_rule<R>::value)
+                return class_rule<R>::get(r1) == class_rule<R>::get(r2);
+            else if constexpr(is_str_rule_v<R>)
+                return rule_traits<R>::str(r1) == rule_traits<R>::str(r2);
+            else if constexpr(kind == rule_kind::sequence || kind == rule_kind::choice)
+            {
+                return std::apply([&](const auto&... rs1)
+                {
+                    return std::apply([&](const auto&... rs2) { return (same_rule(rs1, rs2) && ...); }, r2.get());
+                }, r1.get());
+            }
+            else if constexpr(kind == rule_kind::repeat)
+                return r1.min_occurrence() == r2.min_occurrence() && r1.max_occurrence() == r2.max_occurrence()
+                    && same_rule(r1.rule(), r2.rule()) && same_rule(r1.separator(), r2.separator());
+            else if constexpr(kind == rule_kind::optional || kind == rule_kind::lookahead || kind == rule_kind::named)
+                return same_rule(r1.rule(), r2.rule());
+            else if constexpr(kind == rule_kind::reference)
+                return &r1.get() == &r2.get();
+            else
+                return false;
+        }
+
+        //-------------------------------------------------------------------------
+        /// r_scan_t matches r_many(_ - x, min, max) & y without composite rule overhead,
+        /// x is evaluated only at positions where it can start, and y is not evaluated
+        /// again where x matched, if it's the same rule
+        //-------------------------------------------------------------------------
+        template<class X, class Y>
+        class r_scan_t final
+        {
+            r_first_t<X> x_;
+            Y y_;
+            size_t min_occurrence_;
+            size_t max_occurrence_;
+            bool same_ = false;
+        public:
+            template<class TX, class TY>
+            r_scan_t(TX&& x, TY&& y, size_t min_occurrence, size_t max_occurrence)
+                : x_(std::forward<TX>(x)), y_(std::forward<TY>(y)),
+                min_occurrence_(min_occurrence), max_occurrence_(std::max<size_t>(max_occurrence, 1)) // r_many always tries the first match
+            {
+                if constexpr(std::is_same_v<X, Y>)
+                    same_ = same_rule(x_.rule(), y_);
+            }
+
+            template<class Iterator, class Iterator2>
+            result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+            {
+                static_assert(is_forward_iterator<Iterator>);
+                size_t count = 0;
+                for(; count < max_occurrence_ && i1 != i2; ++i1, ++count)
+                {
+                    auto match = x_(i1, i2);
+                    if(match.matched)
+                    {
+                        if(count < min_occurrence_)
+                            return make_result(false, i1);
+                        // the same pure rule matches the same way again, class rules
+                        // are compared as byte sets, so only for byte input
+                        if constexpr(std::is_same_v<X, Y> && is_byte_input_v<Iterator>)
+                        {
+                            if(same_)
+                                return match;
+                        }
+                        return y_(i1, i2);
+                    }
+                }
+
+                if(count < min_occurrence_)
+                    return make_result(false, i1);
+                return y_(i1, i2);
+            }
+        };
+
+        //-------------------------------------------------------------------------
+        /// r_span_t matches r_many(_ - x1 - ... - xn, min, max) in a single loop,
+        /// each x is evaluated only at positions where it can start
+        //-------------------------------------------------------------------------
+        template<class... Xs>
+        class r_span_t final
+        {
+            std::tuple<r_first_t<Xs>...> xs_;
+            size_t min_occurrence_;
+            size_t max_occurrence_;
+        public:
+            template<class... TXs>
+            r_span_t(size_t min_occurrence, size_t max_occurrence, TXs&&... xs)
+                : xs_(r_first_t<Xs>(std::forward<TXs>(xs))...),
+                min_occurrence_(min_occurrence), max_occurrence_(std::max<size_t>(max_occurrence, 1)) // r_many always tries the first match
+            {}
+
+            template<class Iterator, class Iterator2>
+            result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+            {
+                static_assert(is_forward_iterator<Iterator>);
+                size_t count = 0;
+                for(; count < max_occurrence_ && i1 != i2; ++i1, ++count)
+                {
+                    if(std::apply([&](const auto&... xs) { return (xs(i1, i2).matched || ...); }, xs_))
+                        break;
+                }
+                return make_result(count >= min_occurrence_, i1);
+            }
+        };
+
+        //-------------------------------------------------------------------------
+        // optimizer rewrites rule to equivalent faster rule, unknown rules are copied
+        //-------------------------------------------------------------------------
+        template<class R, class = void>
+        struct optimizer
+        {
+            static R apply(const R& r) { return r; }
+        };
+
+        template<class R>
+        auto optimize_rule(const R& r) { return optimizer<std::remove_cv_t<std::remove_reference_t<R>>>::apply(r); }
+
+        template<class R>
+        using optimized_t = decltype(optimize_rule(std::declval<const R&>()));
+
+        template<class R>
+        constexpr bool is_folded_class_v = false;
+
+        template<class... Rs>
+        constexpr bool is_folded_class_v<r_or_t<Rs...>> = class_rule<r_or_t<Rs...>>::value;
+
+        template<class... Rs>
+        constexpr bool is_folded_class_v<r_and_t<Rs...>> = class_rule<r_and_t<Rs...>>::value;
+
+        // alternatives and differences of character classes become a single bitmap test
+        template<class R>
+        struct optimizer<R, std::enable_if_t<is_folded_class_v<R>>>
+        {
+            static auto apply(const R& r) { return r_pred<is_byte_class_t<R>>(is_byte_class_t<R>(r)); }
+        };
+
+        template<class... Rs>
+        struct optimizer<r_or_t<Rs...>, std::enable_if_t<!is_folded_class_v<r_or_t<Rs...>>>>
+        {
+            static auto apply(const r_or_t<Rs...>& r)
+            {
+                return std::apply([](const auto&... rs) { return r_or_t<optimized_t<Rs>...>(optimize_rule(rs)...); }, r.get());
+            }
+        };
+
+        // *(_ - x) & y sequence
+        template<class M, class Y>
+        constexpr bool is_scan_v = false;
+
+        template<class X, class Y>
+        constexpr bool is_scan_v<r_many_t<r_and_t<r_not_t<X>, r_pred<is_any_t<void>>>, r_empty>, Y> = is_pure_rule_v<X>;
+
+        template<size_t I, class Tuple>
+        constexpr bool is_scan_at()
+        {
+            if constexpr(I + 1 < std::tuple_size_v<Tuple>)
+                return is_scan_v<std::tuple_element_t<I, Tuple>, std::tuple_element_t<I + 1, Tuple>>;
+            else
+                return false;
+        }
+
+        template<size_t I, class Tuple>
+        auto optimize_sequence(const Tuple& rs)
+        {
+            constexpr size_t size = std::tuple_size_v<Tuple>;
+            if constexpr(I == size)
+                return std::tuple<>();
+            else if constexpr(is_scan_at<I, Tuple>())
+            {
+                auto& many = std::get<I>(rs);
+                auto& x = std::get<0>(many.rule().get()).rule();
+                using scan_t = r_scan_t<optimized_t<decltype(x)>, optimized_t<std::tuple_element_t<I + 1, Tuple>>>;
+                return std::tuple_cat(std::make_tuple(scan_t(optimize_rule(x), optimize_rule(std::get<I + 1>(rs)),
+                    many.min_occurrence(), many.max_occurrence())), optimize_sequence<I + 2>(rs));
+            }
+            else
+                return std::tuple_cat(std::make_tuple(optimize_rule(std::get<I>(rs))), optimize_sequence<I + 1>(rs));
+        }
+
+        template<class... Rs>
+        auto make_sequence(std::tuple<Rs...>&& rs)
+        {
+            if constexpr(sizeof...(Rs) == 1)
+                return std::get<0>(std::move(rs));
+            else
+                return std::apply([](auto&&... r) { return r_and_t<Rs...>(std::move(r)...); }, std::move(rs));
+        }
+
+        template<class... Rs>
+        struct optimizer<r_and_t<Rs...>, std::enable_if_t<!is_folded_class_v<r_and_t<Rs...>>>>
+        {
+            static auto apply(const r_and_t<Rs...>& r) { return make_sequence(optimize_sequence<0>(r.get())); }
+        };
+
+        // difference _ - x1 - ... - xn of pure rules, which is flattened to !xn & ... & !x1 & _
+        template<class N>
+        constexpr bool is_pure_negation_v = false;
+
+        template<class X>
+        constexpr bool is_pure_negation_v<r_not_t<X>> = is_pure_rule_v<X>;
+
+        template<class Rs, class = std::make_index_sequence<std::tuple_size_v<Rs> - 1>>
+        struct span_difference : std::false_type {};
+
+        template<class... Rs, size_t... I>
+        struct span_difference<std::tuple<Rs...>, std::index_sequence<I...>>
+            : std::bool_constant<std::is_same_v<std::remove_cv_t<std::remove_reference_t<std::tuple_element_t<sizeof...(I), std::tuple<Rs...>>>>,
+                r_pred<is_any_t<void>>> && (is_pure_negation_v<std::tuple_element_t<I, std::tuple<Rs...>>> && ...)>
+        {
+            template<class M>
+            static auto make_span(const M& many)
+            {
+                auto& rs = many.rule().get();
+                return r_span_t<optimized_t<decltype(std::get<I>(rs).rule())>...>(many.min_occurrence(), many.max_occurrence(),
+                    optimize_rule(std::get<I>(rs).rule())...);
+            }
+        };
+
+        template<class R>
+        struct span_rule : std::false_type {};
+
+        template<class... Rs>
+        struct span_rule<r_and_t<Rs...>> : span_difference<std::tuple<Rs...>> {};
+
+        template<class R>
+        constexpr bool is_pred_rule_v = false;
+
+        template<class Pred>
+        constexpr bool is_pred_rule_v<r_pred<Pred>> = true;
+
+        template<class R, class S>
+        struct optimizer<r_many_t<R, S>>
+        {
+            static auto apply(const r_many_t<R, S>& r)
+            {
+                // repeated character class is matched by a single loop
+                if constexpr(class_rule<R>::value && std::is_same_v<S, r_empty>)
+                {
+                    auto max_occurrence = std::max<size_t>(r.max_occurrence(), 1); // r_many always tries the first match
+                    if constexpr(!is_pred_rule_v<R>)
+                        return r_predstr<is_byte_class_t<R>, true>(is_byte_class_t<R>(r.rule()), r.min_occurrence(), max_occurrence);
+                    else
+                        return r_predstr<std::decay_t<decltype(r.rule().predicate())>, true>(r.rule().predicate(), r.min_occurrence(), max_occurrence);
+                }
+                // repeated difference of pure rules is matched by a single loop
+                else if constexpr(span_rule<R>::value && std::is_same_v<S, r_empty>)
+                    return span_rule<R>::make_span(r);
+                else
+                    return r_many_t<optimized_t<R>, optimized_t<S>>(optimize_rule(r.rule()), optimize_rule(r.separator()),
+                        r.min_occurrence(), r.max_occurrence());
+            }
+        };
+
+        template<class R>
+        struct optimizer<r_opt_t<R>>
+        {
+            static auto apply(const r_opt_t<R>& r) { return r_opt_t<optimized_t<R>>(optimize_rule(r.rule())); }
+        };
+
+        template<class R>
+        struct optimizer<r_test_t<R>>
+        {
+            static auto apply(const r_test_t<R>& r) { return r_test_t<optimized_t<R>>(optimize_rule(r.rule())); }
+        };
+
+        // negation and search of pure rules skip positions where the rule cannot start
+        template<class R>
+        struct optimizer<r_not_t<R>>
+        {
+            static auto apply(const r_not_t<R>& r)
+            {
+                if constexpr(is_pure_rule_v<R> && !class_rule<R>::value)
+                    return r_not_t<r_first_t<optimized_t<R>>>(r_first_t<optimized_t<R>>(optimize_rule(r.rule())));
+                else
+                    return r_not_t<optimized_t<R>>(optimize_rule(r.rule()));
+            }
+        };
+
+        template<class R>
+        struct optimizer<r_find_t<R>>
+        {
+            static auto apply(const r_find_t<R>& r)
+            {
+                if constexpr(is_pure_rule_v<R> && !class_rule<R>::value)
+                    return r_find_t<r_first_t<optimized_t<R>>>(r_first_t<optimized_t<R>>(optimize_rule(r.rule())));
+                else
+                    return r_find_t<optimized_t<R>>(optimize_rule(r.rule()));
+            }
+        };
+
+        template<class R>
+        struct optimizer<r_named_t<R>>
+        {
+            static auto apply(const r_named_t<R>& r) { return r_named_t<optimized_t<R>>(optimize_rule(r.rule()), r.name()); }
+        };
+
+        template<class R, class E>
+        struct optimizer<r_extractor_t<R, E>>
+        {
+            static auto apply(const r_extractor_t<R, E>& r) { return r_extractor_t<optimized_t<R>, E>(optimize_rule(r.rule()), r.extractor()); }
+        };
+    }
+
+    //-------------------------------------------------------------------------
+    /// optimize returns a rule with the same match semantics, rewriting slow idioms:
+    /// differences and alternatives of character classes become bitmap predicates,
+    /// repeated character classes become r_predstr, *(_ - x) & y becomes a scanning loop,
+    /// repeated differences like +(_ - sep - _endl) become a single loop,
+    /// negation and search of pure rules skip positions excluded by the FIRST set;
+    /// rules referenced by std::ref and r_rule are not rewritten,
+    /// data produced by parse_tree from the optimized rule may have a different shape
+    //-------------------------------------------------------------------------
+    template<class R>
+    auto optimize(const R& r) -> detail::enable_if_rule<R, detail::optimized_t<R>>
+    {
+        return detail::optimize_rule(r);
+    }
+}
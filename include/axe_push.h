@@ -0,0 +1,235 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <iterator>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include "axe_trait.h"
+#include "axe_result.h"
+#include "axe_iterator.h"
+#include "axe_action.h"
+
+namespace axe
+{
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // probe_iterator is a pointer that reports when a rule reaches the end of buffered data,
+        // in that case the result may change after more data arrives;
+        // the end is only seen by comparison, so the iterator is forward only: rules can't
+        // measure the distance to the end and must walk to it, which the probe reports
+        //-------------------------------------------------------------------------
+        template<class CharT>
+        class probe_iterator
+        {
+        public:
+            struct probe
+            {
+                const CharT* end;
+                bool hit_end;
+            };
+
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = CharT;
+            using pointer = const CharT*;
+            using reference = const CharT&;
+
+            probe_iterator() = default;
+            probe_iterator(const CharT* p, probe* pr) : p_(p), probe_(pr) {}
+
+            const CharT* get() const { return p_; }
+
+            reference operator* () const { return *p_; }
+            pointer operator->() const { return p_; }
+
+            probe_iterator& operator++ () { ++p_; return *this; }
+            probe_iterator operator++ (int) { auto tmp = *this; ++p_; return tmp; }
+
+            bool operator== (const probe_iterator& other) const
+            {
+                auto equal = p_ == other.p_;
+                if(equal && probe_ && p_ == probe_->end)
+                    probe_->hit_end = true;
+                return equal;
+            }
+
+            bool operator!= (const probe_iterator& other) const { return !operator==(other); }
+
+        private:
+            const CharT* p_ = nullptr;
+            probe* probe_ = nullptr;
+        };
+    }
+
+    //-------------------------------------------------------------------------
+    /// iterator type used by push_parser, e.g. for action_log<push_iterator<>>
+    //-------------------------------------------------------------------------
+    template<class CharT = char>
+    using push_iterator = detail::probe_iterator<CharT>;
+
+    //-------------------------------------------------------------------------
+    /// push_parser matches a record rule repeatedly over data arriving in chunks
+    /// complete records are passed to sink(it_pair<const CharT*>) and discarded,
+    /// only the incomplete record is buffered and matched again from its beginning,
+    /// a record is incomplete when the rule reached the end of buffered data;
+    /// rules can't be suspended, so the whole incomplete record stays buffered and each
+    /// attempt costs its length; to keep the cost linear in the size of a record arriving
+    /// in small chunks, push() retries matching only after the buffered data has doubled,
+    /// so a complete record can be passed to sink a few chunks later; flush() matches
+    /// immediately (e.g. after a request in request/response protocols), finish() always
+    /// matches the remaining data
+    /// extractors may run on incomplete records, use e_deferred with the log passed
+    /// to constructor to execute actions only for complete records
+    //-------------------------------------------------------------------------
+    template<class R, class Sink, class CharT = char>
+    class push_parser
+    {
+    public:
+        using iterator = push_iterator<CharT>;
+
+    private:
+        R r_;
+        Sink sink_;
+        std::basic_string<CharT> buffer_;
+        action_log<iterator> own_log_;
+        action_log<iterator>& log_;
+        size_t consumed_ = 0; // total length of matched records
+        size_t retry_ = 0; // buffer size at which push() matches the incomplete record again
+        bool failed_ = false;
+
+        // matches records in buffer, last is true when no more data will arrive
+        bool match(bool last)
+        {
+            const CharT* begin = buffer_.data();
+            const CharT* end = begin + buffer_.size();
+            typename iterator::probe probe{ end, false };
+            bool waiting = false;
+
+            while(!failed_ && begin != end)
+            {
+                probe.hit_end = false;
+                log_.reset();
+                auto res = [&]
+                {
+                    detail::action_scope scope(log_);
+                    return r_(iterator(begin, &probe), iterator(end, &probe));
+                }();
+
+                if(probe.hit_end && !last)
+                {
+                    waiting = true;
+                    break; // wait for more data
+                }
+
+                if(!res.matched || res.position.get() == begin)
+                {
+                    log_.reset();
+                    failed_ = true;
+                    break;
+                }
+
+                log_.commit();
+                std::invoke(sink_, it_pair<const CharT*>(begin, res.position.get()));
+                consumed_ += res.position.get() - begin;
+                begin = res.position.get();
+            }
+
+            buffer_.erase(0, begin - buffer_.data());
+            retry_ = waiting ? buffer_.size() * 2 : 0;
+            return !failed_;
+        }
+
+    public:
+        template<class RR, class SS>
+        push_parser(RR&& r, SS&& sink) : r_(std::forward<RR>(r)), sink_(std::forward<SS>(sink)), log_(own_log_) {}
+
+        /// log is committed for each complete record
+        template<class RR, class SS>
+        push_parser(RR&& r, SS&& sink, action_log<iterator>& log)
+            : r_(std::forward<RR>(r)), sink_(std::forward<SS>(sink)), log_(log) {}
+
+        push_parser(const push_parser&) = delete;
+        push_parser& operator= (const push_parser&) = delete;
+
+        /// appends chunk and matches complete records, returns false if parsing failed
+        bool push(std::basic_string_view<CharT> chunk)
+        {
+            if(failed_)
+                return false;
+            buffer_.append(chunk.data(), chunk.size());
+            return buffer_.size() < retry_ || match(false);
+        }
+
+        /// matches buffered data without waiting for the retry schedule of push(),
+        /// returns false if parsing failed
+        bool flush()
+        {
+            return !failed_ && match(false);
+        }
+
+        /// matches remaining data at the end of stream, returns true if all data matched
+        bool finish()
+        {
+            return match(true) && buffer_.empty();
+        }
+
+        bool failed() const { return failed_; }
+
+        /// offset of the first unmatched character in the stream
+        size_t consumed() const { return consumed_; }
+
+        /// number of buffered characters of incomplete record
+        size_t buffered() const { return buffer_.size(); }
+    };
+
+    //-------------------------------------------------------------------------
+    /// function make_push_parser creates push_parser for records matched by rule r
+    //-------------------------------------------------------------------------
+    template<class CharT = char, class R, class Sink>
+    inline push_parser<std::decay_t<R>, std::decay_t<Sink>, CharT> make_push_parser(R&& r, Sink&& sink)
+    {
+        return push_parser<std::decay_t<R>, std::decay_t<Sink>, CharT>(std::forward<R>(r), std::forward<Sink>(sink));
+    }
+
+    //-------------------------------------------------------------------------
+    /// function make_push_parser creates push_parser committing deferred actions of complete records
+    //-------------------------------------------------------------------------
+    template<class CharT = char, class R, class Sink>
+    inline push_parser<std::decay_t<R>, std::decay_t<Sink>, CharT> make_push_parser(R&& r, Sink&& sink,
+        action_log<push_iterator<CharT>>& log)
+    {
+        return push_parser<std::decay_t<R>, std::decay_t<Sink>, CharT>(std::forward<R>(r), std::forward<Sink>(sink), log);
+    }
+}
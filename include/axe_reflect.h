@@ -0,0 +1,541 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <bitset>
+#include <tuple>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <functional>
+#include <type_traits>
+#include "axe_trait.h"
+#include "axe_terminal.h"
+#include "axe_composite.h"
+#include "axe_extractor.h"
+#include "axe_dfa.h"
+#include "axe_search.h"
+
+namespace axe
+{
+    //-------------------------------------------------------------------------
+    /// kind of rule reported by reflection
+    //-------------------------------------------------------------------------
+    enum class rule_kind
+    {
+        terminal,   // matches fixed value (r_char, r_str, r_bin, ...)
+        predicate,  // matches elements satisfying predicate (r_pred, r_predstr, character class)
+        sequence,   // r_and_t
+        choice,     // r_or_t
+        repeat,     // r_many_t
+        optional,   // r_opt_t
+        lookahead,  // r_not_t, r_test_t
+        search,     // r_find_t
+        extractor,  // r_extractor_t
+        named,      // r_named_t
+        reference,  // std::reference_wrapper
+        other       // opaque rule, properties are conservative
+    };
+
+    inline const char* to_string(rule_kind kind)
+    {
+        constexpr const char* names[] = { "terminal", "predicate", "sequence", "choice", "repeat",
+            "optional", "lookahead", "search", "extractor", "named", "reference", "other" };
+        return names[static_cast<int>(kind)];
+    }
+
+    using first_set_t = std::bitset<256>;
+
+    //-------------------------------------------------------------------------
+    /// rule_traits describes rule kind, children and static properties:
+    /// nullable - rule can match empty input
+    /// first - set of bytes which can start non-empty match
+    /// fixed_length - length of every match, if it's the same
+    /// unknown rules are reported conservatively (nullable, any first byte, variable length)
+    //-------------------------------------------------------------------------
+    template<class R, class = void>
+    struct rule_traits
+    {
+        static constexpr rule_kind kind = rule_kind::other;
+        using children = std::tuple<>;
+
+        template<class Fn>
+        static void visit(const R&, Fn&&) {}
+        static bool nullable(const R&) { return true; }
+        static first_set_t first(const R&) { return first_set_t().set(); }
+        static std::optional<size_t> fixed_length(const R&) { return std::nullopt; }
+    };
+
+    template<class R>
+    using rule_traits_t = rule_traits<std::remove_cv_t<std::remove_reference_t<R>>>;
+
+    //-------------------------------------------------------------------------
+    // reflection functions
+    //-------------------------------------------------------------------------
+    template<class R>
+    constexpr rule_kind rule_kind_v = rule_traits_t<R>::kind;
+
+    template<class R>
+    constexpr rule_kind kind_of(const R&) { return rule_kind_v<R>; }
+
+    /// calls fn(child) for each child of rule r
+    template<class R, class Fn>
+    void visit_children(const R& r, Fn&& fn) { rule_traits_t<R>::visit(r, std::forward<Fn>(fn)); }
+
+    template<class R>
+    bool is_nullable(const R& r) { return rule_traits_t<R>::nullable(r); }
+
+    template<class R>
+    first_set_t first_set(const R& r) { return rule_traits_t<R>::first(r); }
+
+    template<class R>
+    std::optional<size_t> fixed_length(const R& r) { return rule_traits_t<R>::fixed_length(r); }
+
+    /// calls fn(rule, depth) for rule r and all its descendants in pre-order
+    template<class R, class Fn>
+    void walk(const R& r, Fn&& fn, size_t depth = 0)
+    {
+        fn(r, depth);
+        visit_children(r, [&](const auto& child) { walk(child, fn, depth + 1); });
+    }
+
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // base for rules with a single child (extractor, named, reference)
+        //-------------------------------------------------------------------------
+        template<class R, class Child, rule_kind Kind>
+        struct wrapper_traits
+        {
+            static constexpr rule_kind kind = Kind;
+            using children = std::tuple<Child>;
+
+            static const auto& child(const R& r)
+            {
+                if constexpr(Kind == rule_kind::reference)
+                    return r.get();
+                else
+                    return r.rule();
+            }
+
+            template<class Fn>
+            static void visit(const R& r, Fn&& fn) { fn(child(r)); }
+            static bool nullable(const R& r) { return is_nullable(child(r)); }
+            static first_set_t first(const R& r) { return first_set(child(r)); }
+            static std::optional<size_t> fixed_length(const R& r) { return axe::fixed_length(child(r)); }
+        };
+
+        inline first_set_t first_byte(unsigned char c) { return first_set_t().set(c); }
+    }
+
+    //-------------------------------------------------------------------------
+    // character classes (r_char, r_pred, differences of classes, ...)
+    //-------------------------------------------------------------------------
+    template<class R>
+    struct rule_traits<R, std::enable_if_t<detail::class_rule<R>::value>>
+    {
+        static constexpr rule_kind kind = rule_kind::predicate;
+        using children = std::tuple<>;
+
+        template<class Fn>
+        static void visit(const R&, Fn&&) {}
+        static bool nullable(const R&) { return false; }
+        static first_set_t first(const R& r) { return detail::class_rule<R>::get(r); }
+        static std::optional<size_t> fixed_length(const R&) { return 1; }
+    };
+
+    //-------------------------------------------------------------------------
+    // terminals
+    //-------------------------------------------------------------------------
+    template<class R>
+    struct terminal_traits
+    {
+        static constexpr rule_kind kind = rule_kind::terminal;
+        using children = std::tuple<>;
+
+        template<class Fn>
+        static void visit(const R&, Fn&&) {}
+    };
+
+    template<class CharT>
+    struct rule_traits<r_char<CharT>, std::enable_if_t<!detail::class_rule<r_char<CharT>>::value>>
+        : terminal_traits<r_char<CharT>>
+    {
+        static bool nullable(const r_char<CharT>&) { return false; }
+        static first_set_t first(const r_char<CharT>&) { return first_set_t().set(); }
+        static std::optional<size_t> fixed_length(const r_char<CharT>&) { return 1; }
+    };
+
+    template<class CharT>
+    struct rule_traits<r_str<CharT>> : terminal_traits<r_str<CharT>>
+    {
+        static auto str(const r_str<CharT>& r)
+        {
+            if constexpr(std::is_pointer_v<decltype(r.name())>)
+                return r.name() ? std::basic_string_view(r.name()) : decltype(std::basic_string_view(r.name()))();
+            else
+                return std::basic_string_view(r.name());
+        }
+
+        static bool nullable(const r_str<CharT>& r) { return str(r).empty(); }
+
+        static first_set_t first(const r_str<CharT>& r)
+        {
+            auto s = str(r);
+            if(s.empty())
+                return {};
+            if constexpr(sizeof(s[0]) == 1)
+                return detail::first_byte(static_cast<unsigned char>(s[0]));
+            else
+                return first_set_t().set();
+        }
+
+        static std::optional<size_t> fixed_length(const r_str<CharT>& r) { return str(r).size(); }
+    };
+
+    template<auto C1, auto... C>
+    struct rule_traits<r_strlit<C1, C...>, std::enable_if_t<!detail::class_rule<r_strlit<C1, C...>>::value>>
+        : terminal_traits<r_strlit<C1, C...>>
+    {
+        static bool nullable(const r_strlit<C1, C...>&) { return false; }
+
+        static first_set_t first(const r_strlit<C1, C...>&)
+        {
+            if constexpr(sizeof(C1) == 1)
+                return detail::first_byte(static_cast<unsigned char>(C1));
+            else
+                return first_set_t().set();
+        }
+
+        static std::optional<size_t> fixed_length(const r_strlit<C1, C...>&) { return 1 + sizeof...(C); }
+    };
+
+    template<class CharT>
+    struct rule_traits<r_istr<CharT>> : terminal_traits<r_istr<CharT>>
+    {
+        static bool nullable(const r_istr<CharT>& r) { return r.str().empty(); }
+
+        static first_set_t first(const r_istr<CharT>& r)
+        {
+            if(r.str().empty())
+                return {};
+            if constexpr(sizeof(CharT) == 1)
+            {
+                auto c = static_cast<unsigned char>(r.str()[0]);
+                auto set = detail::first_byte(c);
+                if(c >= 'a' && c <= 'z')
+                    set.set(c & ~0x20);
+                return set;
+            }
+            else
+                return first_set_t().set();
+        }
+
+        static std::optional<size_t> fixed_length(const r_istr<CharT>& r) { return r.str().size(); }
+    };
+
+    template<>
+    struct rule_traits<r_dfa> : terminal_traits<r_dfa>
+    {
+        static bool nullable(const r_dfa& r) { return r.automaton().accept(r.automaton().start()) >= 0; }
+
+        static first_set_t first(const r_dfa& r)
+        {
+            first_set_t set;
+            for(size_t c = 0; c < 256; ++c)
+                set[c] = r.automaton().next(r.automaton().start(), static_cast<unsigned char>(c)) != detail::dfa::dead;
+            return set;
+        }
+
+        static std::optional<size_t> fixed_length(const r_dfa&) { return std::nullopt; }
+    };
+
+    template<>
+    struct rule_traits<r_find_any> : terminal_traits<r_find_any>
+    {
+        static constexpr rule_kind kind = rule_kind::search;
+        static bool nullable(const r_find_any& r) { return r.has_empty(); }
+        static first_set_t first(const r_find_any&) { return first_set_t().set(); }
+        static std::optional<size_t> fixed_length(const r_find_any&) { return std::nullopt; }
+    };
+
+    template<class T>
+    struct rule_traits<r_bin<T>> : terminal_traits<r_bin<T>>
+    {
+        static bool nullable(const r_bin<T>&) { return false; }
+        static first_set_t first(const r_bin<T>&) { return first_set_t().set(); }
+        static std::optional<size_t> fixed_length(const r_bin<T>&) { return sizeof(T); }
+    };
+
+    template<>
+    struct rule_traits<r_empty> : terminal_traits<r_empty>
+    {
+        static bool nullable(const r_empty&) { return true; }
+        static first_set_t first(const r_empty&) { return {}; }
+        static std::optional<size_t> fixed_length(const r_empty&) { return 0; }
+    };
+
+    template<>
+    struct rule_traits<r_end> : terminal_traits<r_end>
+    {
+        static bool nullable(const r_end&) { return true; }
+        static first_set_t first(const r_end&) { return {}; }
+        static std::optional<size_t> fixed_length(const r_end&) { return 0; }
+    };
+
+    template<>
+    struct rule_traits<r_ident> : terminal_traits<r_ident>
+    {
+        static bool nullable(const r_ident&) { return false; }
+        static first_set_t first(const r_ident&) { return detail::class_rule<r_pred<is_alpha>>::get(r_pred<is_alpha>(is_alpha())); }
+        static std::optional<size_t> fixed_length(const r_ident&) { return std::nullopt; }
+    };
+
+    template<class Pred, bool Occurrence>
+    struct rule_traits<r_predstr<Pred, Occurrence>> : terminal_traits<r_predstr<Pred, Occurrence>>
+    {
+        static constexpr rule_kind kind = rule_kind::predicate;
+        using R = r_predstr<Pred, Occurrence>;
+
+        static size_t min_occurrence(const R& r)
+        {
+            if constexpr(Occurrence)
+                return r.min_occurrence();
+            else
+                return 1;
+        }
+
+        static bool nullable(const R& r) { return min_occurrence(r) == 0; }
+
+        static first_set_t first(const R& r)
+        {
+            if constexpr(detail::class_rule<r_pred<Pred>>::value)
+                return detail::class_rule<r_pred<Pred>>::get(r_pred<Pred>(r.predicate()));
+            else
+                return first_set_t().set();
+        }
+
+        static std::optional<size_t> fixed_length(const R& r)
+        {
+            if constexpr(Occurrence)
+            {
+                if(r.min_occurrence() == r.max_occurrence())
+                    return r.min_occurrence();
+            }
+            return std::nullopt;
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    // composite rules
+    //-------------------------------------------------------------------------
+    template<class... Rs>
+    struct rule_traits<r_and_t<Rs...>, std::enable_if_t<!detail::class_rule<r_and_t<Rs...>>::value>>
+    {
+        static constexpr rule_kind kind = rule_kind::sequence;
+        using children = std::tuple<std::remove_cv_t<std::remove_reference_t<Rs>>...>;
+
+        template<class Fn>
+        static void visit(const r_and_t<Rs...>& r, Fn&& fn)
+        {
+            std::apply([&](const auto&... rs) { (fn(rs), ...); }, r.get());
+        }
+
+        static bool nullable(const r_and_t<Rs...>& r)
+        {
+            return std::apply([](const auto&... rs) { return (is_nullable(rs) && ...); }, r.get());
+        }
+
+        static first_set_t first(const r_and_t<Rs...>& r)
+        {
+            first_set_t set;
+            bool prefix_nullable = true;
+            visit(r, [&](const auto& child)
+            {
+                if(prefix_nullable)
+                {
+                    set |= first_set(child);
+                    prefix_nullable = is_nullable(child);
+                }
+            });
+            return set;
+        }
+
+        static std::optional<size_t> fixed_length(const r_and_t<Rs...>& r)
+        {
+            std::optional<size_t> length = 0;
+            visit(r, [&](const auto& child)
+            {
+                auto l = axe::fixed_length(child);
+                length = length && l ? std::optional<size_t>(*length + *l) : std::nullopt;
+            });
+            return length;
+        }
+    };
+
+    template<class... Rs>
+    struct rule_traits<r_or_t<Rs...>, std::enable_if_t<!detail::class_rule<r_or_t<Rs...>>::value>>
+    {
+        static constexpr rule_kind kind = rule_kind::choice;
+        using children = std::tuple<std::remove_cv_t<std::remove_reference_t<Rs>>...>;
+
+        template<class Fn>
+        static void visit(const r_or_t<Rs...>& r, Fn&& fn)
+        {
+            std::apply([&](const auto&... rs) { (fn(rs), ...); }, r.get());
+        }
+
+        static bool nullable(const r_or_t<Rs...>& r)
+        {
+            return std::apply([](const auto&... rs) { return (is_nullable(rs) || ...); }, r.get());
+        }
+
+        static first_set_t first(const r_or_t<Rs...>& r)
+        {
+            return std::apply([](const auto&... rs) { return (first_set(rs) | ...); }, r.get());
+        }
+
+        static std::optional<size_t> fixed_length(const r_or_t<Rs...>& r)
+        {
+            return std::apply([](const auto& r1, const auto&... rs)
+            {
+                auto length = axe::fixed_length(r1);
+                return ((length == axe::fixed_length(rs)) && ...) ? length : std::nullopt;
+            }, r.get());
+        }
+    };
+
+    template<class R, class S>
+    struct rule_traits<r_many_t<R, S>>
+    {
+        static constexpr rule_kind kind = rule_kind::repeat;
+        using children = std::tuple<std::remove_cv_t<std::remove_reference_t<R>>, std::remove_cv_t<std::remove_reference_t<S>>>;
+
+        template<class Fn>
+        static void visit(const r_many_t<R, S>& r, Fn&& fn)
+        {
+            fn(r.rule());
+            fn(r.separator());
+        }
+
+        static bool nullable(const r_many_t<R, S>& r) { return r.min_occurrence() == 0 || is_nullable(r.rule()); }
+
+        static first_set_t first(const r_many_t<R, S>& r)
+        {
+            auto set = first_set(r.rule());
+            if(is_nullable(r.rule()))
+                set |= first_set(r.separator());
+            return set;
+        }
+
+        static std::optional<size_t> fixed_length(const r_many_t<R, S>& r)
+        {
+            auto count = r.min_occurrence();
+            if(count != r.max_occurrence())
+                return std::nullopt;
+            if(count == 0)
+                return 0;
+
+            auto length = axe::fixed_length(r.rule());
+            auto separator = axe::fixed_length(r.separator());
+            if(!length || !separator)
+                return std::nullopt;
+            return count * *length + (count - 1) * *separator;
+        }
+    };
+
+    template<class R>
+    struct rule_traits<r_opt_t<R>>
+    {
+        static constexpr rule_kind kind = rule_kind::optional;
+        using children = std::tuple<std::remove_cv_t<std::remove_reference_t<R>>>;
+
+        template<class Fn>
+        static void visit(const r_opt_t<R>& r, Fn&& fn) { fn(r.rule()); }
+        static bool nullable(const r_opt_t<R>&) { return true; }
+        static first_set_t first(const r_opt_t<R>& r) { return first_set(r.rule()); }
+
+        static std::optional<size_t> fixed_length(const r_opt_t<R>& r)
+        {
+            return axe::fixed_length(r.rule()) == size_t(0) ? std::optional<size_t>(0) : std::nullopt;
+        }
+    };
+
+    template<class R>
+    struct rule_traits<r_not_t<R>>
+    {
+        static constexpr rule_kind kind = rule_kind::lookahead;
+        using children = std::tuple<std::remove_cv_t<std::remove_reference_t<R>>>;
+
+        template<class Fn>
+        static void visit(const r_not_t<R>& r, Fn&& fn) { fn(r.rule()); }
+        static bool nullable(const r_not_t<R>&) { return true; }
+        static first_set_t first(const r_not_t<R>&) { return {}; }
+        static std::optional<size_t> fixed_length(const r_not_t<R>&) { return 0; }
+    };
+
+    template<class R>
+    struct rule_traits<r_test_t<R>>
+    {
+        static constexpr rule_kind kind = rule_kind::lookahead;
+        using children = std::tuple<std::remove_cv_t<std::remove_reference_t<R>>>;
+
+        template<class Fn>
+        static void visit(const r_test_t<R>& r, Fn&& fn) { fn(r.rule()); }
+        static bool nullable(const r_test_t<R>&) { return true; }
+        static first_set_t first(const r_test_t<R>&) { return {}; }
+        static std::optional<size_t> fixed_length(const r_test_t<R>&) { return 0; }
+    };
+
+    template<class R>
+    struct rule_traits<r_find_t<R>>
+    {
+        static constexpr rule_kind kind = rule_kind::search;
+        using children = std::tuple<std::remove_cv_t<std::remove_reference_t<R>>>;
+
+        template<class Fn>
+        static void visit(const r_find_t<R>& r, Fn&& fn) { fn(r.rule()); }
+        static bool nullable(const r_find_t<R>& r) { return is_nullable(r.rule()); }
+        static first_set_t first(const r_find_t<R>&) { return first_set_t().set(); }
+        static std::optional<size_t> fixed_length(const r_find_t<R>&) { return std::nullopt; }
+    };
+
+    template<class R, class E>
+    struct rule_traits<r_extractor_t<R, E>>
+        : detail::wrapper_traits<r_extractor_t<R, E>, std::remove_cv_t<std::remove_reference_t<R>>, rule_kind::extractor> {};
+
+    template<class R>
+    struct rule_traits<r_named_t<R>, std::enable_if_t<!detail::class_rule<r_named_t<R>>::value>>
+        : detail::wrapper_traits<r_named_t<R>, std::remove_cv_t<std::remove_reference_t<R>>, rule_kind::named> {};
+
+    template<class R>
+    struct rule_traits<std::reference_wrapper<R>>
+        : detail::wrapper_traits<std::reference_wrapper<R>, std::remove_cv_t<R>, rule_kind::reference> {};
+}
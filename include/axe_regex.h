@@ -0,0 +1,752 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <array>
+#include <map>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include "axe_trait.h"
+#include "axe_result.h"
+#include "axe_detail.h"
+#include "axe_dfa.h"
+
+namespace axe
+{
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // regex_node is a syntax tree of regular subset of ECMAScript regex
+        //-------------------------------------------------------------------------
+        struct regex_node
+        {
+            enum kind_t { bytes, sequence, choice, repeat } kind = sequence;
+            byte_set set;
+            std::vector<regex_node> children;
+            size_t min_occurrence = 0;
+            size_t max_occurrence = 0;
+            bool greedy = true;
+        };
+
+        //-------------------------------------------------------------------------
+        // regex_parser accepts literals, escapes, character classes, '.', groups,
+        // alternatives and quantifiers (including lazy ones);
+        // assertions, back references, repeated subexpressions matching empty string
+        // and other features are reported as unsupported
+        //-------------------------------------------------------------------------
+        class regex_parser
+        {
+            std::string_view p_;
+            size_t pos_ = 0;
+            bool supported_ = true;
+
+            bool at_end() const { return pos_ == p_.size(); }
+            char peek() const { return p_[pos_]; }
+
+            static byte_set range(unsigned char from, unsigned char to)
+            {
+                byte_set set;
+                for(size_t c = from; c <= to; ++c)
+                    set.set(c);
+                return set;
+            }
+
+            static byte_set single(unsigned char c) { return byte_set().set(c); }
+
+            static byte_set digits() { return range('0', '9'); }
+            static byte_set words() { return range('0', '9') | range('A', 'Z') | range('a', 'z') | single('_'); }
+            static byte_set spaces() { return range('\t', '\r') | single(' '); }
+
+            std::optional<byte_set> unsupported()
+            {
+                supported_ = false;
+                return std::nullopt;
+            }
+
+            static int hex(char c)
+            {
+                if(c >= '0' && c <= '9') return c - '0';
+                if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+                if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+                return -1;
+            }
+
+            // escape sequence after '\', in_class changes meaning of \b
+            std::optional<byte_set> escape(bool in_class)
+            {
+                if(at_end())
+                    return unsupported();
+
+                auto c = p_[pos_++];
+                switch(c)
+                {
+                case 'd': return digits();
+                case 'D': return ~digits();
+                case 'w': return words();
+                case 'W': return ~words();
+                case 's': return spaces();
+                case 'S': return ~spaces();
+                case 't': return single('\t');
+                case 'n': return single('\n');
+                case 'r': return single('\r');
+                case 'f': return single('\f');
+                case 'v': return single('\v');
+                case '0': return single('\0');
+                case 'b': return in_class ? std::optional<byte_set>(single('\b')) : unsupported();
+                case 'x':
+                    if(pos_ + 2 <= p_.size() && hex(p_[pos_]) >= 0 && hex(p_[pos_ + 1]) >= 0)
+                    {
+                        auto value = hex(p_[pos_]) * 16 + hex(p_[pos_ + 1]);
+                        pos_ += 2;
+                        return single(static_cast<unsigned char>(value));
+                    }
+                    return unsupported();
+                default:
+                    // escaped punctuation is literal, letters and digits have special meaning
+                    if((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+                        return unsupported();
+                    return single(static_cast<unsigned char>(c));
+                }
+            }
+
+            static int first_byte(const byte_set& set)
+            {
+                for(size_t c = 0; c < 256; ++c)
+                    if(set[c])
+                        return static_cast<int>(c);
+                return -1;
+            }
+
+            // class atom returns matching set and the character code usable in range (or -1)
+            std::optional<std::pair<byte_set, int>> class_atom()
+            {
+                auto c = p_[pos_++];
+                if(c != '\\')
+                    return std::pair(single(static_cast<unsigned char>(c)), static_cast<int>(static_cast<unsigned char>(c)));
+
+                auto set = escape(true);
+                if(!set)
+                    return std::nullopt;
+                return std::pair(*set, set->count() == 1 ? first_byte(*set) : -1);
+            }
+
+            std::optional<byte_set> char_class()
+            {
+                bool negate = !at_end() && peek() == '^';
+                if(negate)
+                    ++pos_;
+
+                byte_set set;
+                while(!at_end() && peek() != ']')
+                {
+                    auto from = class_atom();
+                    if(!from)
+                        return std::nullopt;
+
+                    if(pos_ + 1 < p_.size() && peek() == '-' && p_[pos_ + 1] != ']')
+                    {
+                        ++pos_;
+                        auto to = class_atom();
+                        if(!to)
+                            return std::nullopt;
+                        if(from->second < 0 || to->second < 0 || from->second > to->second)
+                            return unsupported();
+                        set |= range(static_cast<unsigned char>(from->second), static_cast<unsigned char>(to->second));
+                    }
+                    else
+                        set |= from->first;
+                }
+
+                if(at_end())
+                    return unsupported();
+                ++pos_; // ]
+                return negate ? ~set : set;
+            }
+
+            std::optional<size_t> number()
+            {
+                if(at_end() || peek() < '0' || peek() > '9')
+                    return std::nullopt;
+                size_t value = 0;
+                for(; !at_end() && peek() >= '0' && peek() <= '9'; ++pos_)
+                    value = value * 10 + (peek() - '0');
+                return value;
+            }
+
+            std::optional<regex_node> atom()
+            {
+                regex_node node;
+                node.kind = regex_node::bytes;
+                auto c = p_[pos_++];
+                switch(c)
+                {
+                case '.':
+                    node.set = ~(single('\n') | single('\r'));
+                    return node;
+                case '[':
+                {
+                    auto set = char_class();
+                    if(!set)
+                        return std::nullopt;
+                    node.set = *set;
+                    return node;
+                }
+                case '\\':
+                {
+                    auto set = escape(false);
+                    if(!set)
+                        return std::nullopt;
+                    node.set = *set;
+                    return node;
+                }
+                case '(':
+                {
+                    if(!at_end() && peek() == '?')
+                    {
+                        if(pos_ + 1 < p_.size() && p_[pos_ + 1] == ':')
+                            pos_ += 2;
+                        else
+                        {
+                            unsupported(); // lookahead
+                            return std::nullopt;
+                        }
+                    }
+                    auto inner = alternatives();
+                    if(!inner || at_end() || peek() != ')')
+                    {
+                        unsupported();
+                        return std::nullopt;
+                    }
+                    ++pos_;
+                    return inner;
+                }
+                case '^': case '$': case ')': case '*': case '+': case '?': case '{': case '}': case ']': case '|':
+                    unsupported();
+                    return std::nullopt;
+                default:
+                    node.set = single(static_cast<unsigned char>(c));
+                    return node;
+                }
+            }
+
+            static bool nullable(const regex_node& node)
+            {
+                switch(node.kind)
+                {
+                case regex_node::bytes:
+                    return false;
+                case regex_node::sequence:
+                    return std::all_of(node.children.begin(), node.children.end(), nullable);
+                case regex_node::choice:
+                    return std::any_of(node.children.begin(), node.children.end(), nullable);
+                default:
+                    return node.min_occurrence == 0 || nullable(node.children.front());
+                }
+            }
+
+            std::optional<regex_node> quantified()
+            {
+                auto node = atom();
+                while(node && !at_end())
+                {
+                    size_t min_occurrence = 0, max_occurrence = size_t(-1);
+                    auto c = peek();
+                    if(c == '*')
+                        ++pos_;
+                    else if(c == '+')
+                        ++pos_, min_occurrence = 1;
+                    else if(c == '?')
+                        ++pos_, max_occurrence = 1;
+                    else if(c == '{')
+                    {
+                        ++pos_;
+                        auto from = number();
+                        if(!from)
+                        {
+                            unsupported();
+                            return std::nullopt;
+                        }
+                        min_occurrence = max_occurrence = *from;
+                        if(!at_end() && peek() == ',')
+                        {
+                            ++pos_;
+                            auto to = number();
+                            max_occurrence = to ? *to : size_t(-1);
+                        }
+                        if(at_end() || peek() != '}' || min_occurrence > max_occurrence)
+                        {
+                            unsupported();
+                            return std::nullopt;
+                        }
+                        ++pos_;
+                    }
+                    else
+                        break;
+
+                    regex_node repeat;
+                    repeat.kind = regex_node::repeat;
+                    repeat.min_occurrence = min_occurrence;
+                    repeat.max_occurrence = max_occurrence;
+                    if(!at_end() && peek() == '?')
+                    {
+                        ++pos_;
+                        repeat.greedy = false;
+                    }
+                    // ECMAScript rejects empty iterations and backtracks into the loop body,
+                    // which automata don't reproduce
+                    if(max_occurrence > 1 && nullable(*node))
+                    {
+                        unsupported();
+                        return std::nullopt;
+                    }
+                    repeat.children.push_back(std::move(*node));
+                    node = std::move(repeat);
+                }
+                return node;
+            }
+
+            std::optional<regex_node> sequence()
+            {
+                regex_node node;
+                node.kind = regex_node::sequence;
+                while(!at_end() && peek() != '|' && peek() != ')')
+                {
+                    auto item = quantified();
+                    if(!item)
+                        return std::nullopt;
+                    node.children.push_back(std::move(*item));
+                }
+                return node;
+            }
+
+            std::optional<regex_node> alternatives()
+            {
+                auto node = sequence();
+                if(!node || at_end() || peek() != '|')
+                    return node;
+
+                regex_node choice;
+                choice.kind = regex_node::choice;
+                choice.children.push_back(std::move(*node));
+                while(!at_end() && peek() == '|')
+                {
+                    ++pos_;
+                    auto next = sequence();
+                    if(!next)
+                        return std::nullopt;
+                    choice.children.push_back(std::move(*next));
+                }
+                return choice;
+            }
+
+        public:
+            explicit regex_parser(std::string_view pattern) : p_(pattern) {}
+
+            std::optional<regex_node> parse()
+            {
+                auto node = alternatives();
+                if(!node || !supported_ || !at_end())
+                    return std::nullopt;
+                return node;
+            }
+        };
+
+        //-------------------------------------------------------------------------
+        // regex_program matches regular subset of ECMAScript regex at the current position;
+        // nfa states are kept in priority order and threads after accepting state are dropped,
+        // which gives backtracking (leftmost first) semantics in linear time;
+        // ordered state lists are compiled to dfa, Pike VM is used when dfa grows too large
+        //-------------------------------------------------------------------------
+        class regex_program
+        {
+            using thread_list = std::vector<size_t>;
+            static constexpr size_t max_dfa_states = 4096;
+            static constexpr uint32_t dead = 0;
+
+            nfa nfa_;
+            size_t start_ = 0;
+            size_t accept_ = 0;
+
+            std::array<unsigned char, 256> classes_{};
+            size_t class_count_ = 0;
+            std::vector<uint32_t> next_;
+            std::vector<char> accepting_;
+            uint32_t start_state_ = dead;
+            bool has_dfa_ = false;
+
+            // lazy quantifiers prefer leaving the loop, so exit is linked before the body
+            nfa::fragment build(const regex_node& node)
+            {
+                switch(node.kind)
+                {
+                case regex_node::bytes:
+                    return nfa_.symbol(node.set);
+                case regex_node::sequence:
+                {
+                    auto f = nfa_.empty();
+                    for(auto& child : node.children)
+                        f = nfa_.concat(f, build(child));
+                    return f;
+                }
+                case regex_node::choice:
+                {
+                    auto s = nfa_.add_state();
+                    auto e = nfa_.add_state();
+                    for(auto& child : node.children)
+                    {
+                        auto f = build(child);
+                        nfa_.link(s, f.start);
+                        nfa_.link(f.end, e);
+                    }
+                    return { s, e };
+                }
+                default:
+                {
+                    auto make = [&] { return build(node.children.front()); };
+                    if(node.greedy)
+                        return nfa_.repeat(make, node.min_occurrence, node.max_occurrence);
+
+                    auto f = nfa_.empty();
+                    size_t count = 0;
+                    for(; count < node.min_occurrence; ++count)
+                        f = nfa_.concat(f, make());
+
+                    if(node.max_occurrence == size_t(-1))
+                    {
+                        auto s = nfa_.add_state();
+                        auto e = nfa_.add_state();
+                        nfa_.link(s, e);
+                        auto body = make();
+                        nfa_.link(s, body.start);
+                        nfa_.link(body.end, s);
+                        return nfa_.concat(f, { s, e });
+                    }
+
+                    // optional copies are nested (x(x)??)?? from the innermost one, so all
+                    // ways to match fewer copies are tried before the next copy
+                    auto e = nfa_.add_state();
+                    auto next = e;
+                    for(; count < node.max_occurrence; ++count)
+                    {
+                        auto s = nfa_.add_state();
+                        nfa_.link(s, e);
+                        auto body = make();
+                        nfa_.link(s, body.start);
+                        nfa_.link(body.end, next);
+                        next = s;
+                    }
+                    return nfa_.concat(f, { next, e });
+                }
+                }
+            }
+
+            // adds state s and states reachable by epsilon transitions in priority order,
+            // returns true if accepting state was added
+            bool add_thread(thread_list& list, std::vector<size_t>& mark, size_t generation,
+                thread_list& stack, size_t s) const
+            {
+                stack.push_back(s);
+                while(!stack.empty())
+                {
+                    auto state = stack.back();
+                    stack.pop_back();
+                    if(mark[state] == generation)
+                        continue;
+                    mark[state] = generation;
+
+                    auto& st = nfa_.states()[state];
+                    if(state == accept_)
+                    {
+                        list.push_back(state);
+                        stack.clear();
+                        return true;
+                    }
+
+                    if(!st.edges.empty())
+                        list.push_back(state);
+                    for(auto e = st.epsilon.rbegin(); e != st.epsilon.rend(); ++e)
+                        stack.push_back(*e);
+                }
+                return false;
+            }
+
+            // computes next thread list, threads with lower priority than accepting state are dropped
+            void step(const thread_list& current, unsigned char c, thread_list& next,
+                std::vector<size_t>& mark, size_t generation, thread_list& stack) const
+            {
+                next.clear();
+                for(auto state : current)
+                {
+                    for(auto& edge : nfa_.states()[state].edges)
+                    {
+                        if(edge.first[c] && add_thread(next, mark, generation, stack, edge.second))
+                            return;
+                    }
+                }
+            }
+
+            void make_classes()
+            {
+                std::map<std::vector<size_t>, unsigned char> signatures;
+                for(size_t b = 0; b < 256; ++b)
+                {
+                    std::vector<size_t> signature;
+                    size_t index = 0;
+                    for(auto& s : nfa_.states())
+                        for(auto& edge : s.edges)
+                        {
+                            if(edge.first[b])
+                                signature.push_back(index);
+                            ++index;
+                        }
+
+                    auto [it, inserted] = signatures.emplace(std::move(signature), static_cast<unsigned char>(signatures.size()));
+                    classes_[b] = it->second;
+                }
+                class_count_ = signatures.size();
+            }
+
+            // compiles ordered thread lists to dfa, fails if the number of states exceeds the limit
+            bool make_dfa()
+            {
+                if(nfa_.states().size() > max_dfa_states)
+                    return false;
+
+                make_classes();
+                std::array<unsigned char, 256> representative{};
+                for(size_t b = 256; b-- > 0;)
+                    representative[classes_[b]] = static_cast<unsigned char>(b);
+
+                std::map<thread_list, uint32_t> states;
+                std::vector<thread_list> pending;
+                auto add = [&](thread_list&& list)
+                {
+                    auto [it, inserted] = states.emplace(std::move(list), static_cast<uint32_t>(pending.size()));
+                    if(inserted)
+                    {
+                        accepting_.push_back(!it->first.empty() && it->first.back() == accept_);
+                        next_.resize(next_.size() + class_count_, dead);
+                        pending.push_back(it->first);
+                    }
+                    return it->second;
+                };
+
+                std::vector<size_t> mark(nfa_.states().size(), 0);
+                size_t generation = 0;
+                thread_list list, stack;
+
+                add(thread_list{}); // dead state
+                add_thread(list, mark, ++generation, stack, start_);
+                start_state_ = add(std::move(list));
+
+                for(size_t d = 1; d < pending.size(); ++d)
+                {
+                    if(pending.size() > max_dfa_states)
+                        return false;
+
+                    for(size_t c = 0; c < class_count_; ++c)
+                    {
+                        thread_list next;
+                        step(pending[d], representative[c], next, mark, ++generation, stack);
+                        if(!next.empty())
+                        {
+                            auto target = add(std::move(next));
+                            next_[d * class_count_ + c] = target;
+                        }
+                    }
+                }
+                return true;
+            }
+
+            template<class Iterator, class Iterator2>
+            std::optional<Iterator> match_dfa(Iterator i1, Iterator2 i2) const
+            {
+                std::optional<Iterator> last;
+                auto state = start_state_;
+                if(accepting_[state])
+                    last = i1;
+
+                for(auto i = i1; i != i2;)
+                {
+                    state = next_[state * class_count_ + classes_[static_cast<unsigned char>(*i)]];
+                    if(state == dead)
+                        break;
+                    ++i;
+                    if(accepting_[state])
+                        last = i;
+                }
+                return last;
+            }
+
+            template<class Iterator, class Iterator2>
+            std::optional<Iterator> match_nfa(Iterator i1, Iterator2 i2) const
+            {
+                std::vector<size_t> mark(nfa_.states().size(), 0);
+                size_t generation = 0;
+                thread_list current, next, stack;
+                std::optional<Iterator> last;
+
+                add_thread(current, mark, ++generation, stack, start_);
+                for(auto i = i1; !current.empty(); ++i)
+                {
+                    if(current.back() == accept_)
+                    {
+                        last = i;
+                        current.pop_back();
+                    }
+                    if(i == i2 || current.empty())
+                        break;
+                    step(current, static_cast<unsigned char>(*i), next, mark, ++generation, stack);
+                    current.swap(next);
+                }
+                return last;
+            }
+
+        public:
+            explicit regex_program(const regex_node& node)
+            {
+                auto f = nfa_.concat(build(node), nfa_.empty());
+                start_ = f.start;
+                accept_ = f.end;
+                has_dfa_ = make_dfa();
+                if(!has_dfa_)
+                {
+                    next_.clear();
+                    accepting_.clear();
+                }
+            }
+
+            /// returns the end of match or nullopt
+            template<class Iterator, class Iterator2>
+            std::optional<Iterator> match(Iterator i1, Iterator2 i2) const
+            {
+                return has_dfa_ ? match_dfa(i1, i2) : match_nfa(i1, i2);
+            }
+        };
+
+        template<class CharT, class Traits, class Arg>
+        std::shared_ptr<const regex_program> compile_regex(const Arg& arg, std::regex_constants::syntax_option_type flags)
+        {
+            using namespace std::regex_constants;
+            constexpr auto unsupported_flags = icase | collate | basic | extended | awk | grep | egrep;
+
+            if constexpr(std::is_same_v<CharT, char> && std::is_same_v<Traits, std::regex_traits<char>>
+                && std::is_convertible_v<const Arg&, std::string_view>)
+            {
+                if((flags & unsupported_flags) == 0)
+                {
+                    if(auto node = regex_parser(std::string_view(arg)).parse())
+                        return std::make_shared<const regex_program>(*node);
+                }
+            }
+            return nullptr;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// r_regex creates rule from regular expression, the match is anchored at the current position;
+    /// regular subset of ECMAScript syntax is compiled to automata and runs in linear time,
+    /// other patterns (assertions, back references, non default grammars) use std::regex
+    //-------------------------------------------------------------------------
+    template<class CharT, class Traits = std::regex_traits<CharT>>
+    class r_regex final 
+    {
+        using Self = r_regex<CharT, Traits>;
+        std::basic_regex<CharT, Traits> rx; // regex to match
+        std::shared_ptr<const detail::regex_program> program_; // compiled regular subset
+
+        template<class I>
+        result<I> search(I i1, I i2) const
+        {
+            std::match_results<I> mr;
+            auto matched = std::regex_search(i1, i2, mr, rx, std::regex_constants::match_continuous);
+            return make_result(matched, matched ? mr[0].second : i1, i1);
+        }
+
+    public:
+        template<class Arg, class... Args, class = detail::disable_copy<Arg, Self>>
+        explicit r_regex(Arg&& arg, Args&& ...args) : rx(arg, std::forward<Args>(args)...),
+            program_(detail::compile_regex<CharT, Traits>(arg, rx.flags()))
+        {}
+
+        template<class I, class I2>
+        result<I> operator() (I i1, I2 i2) const
+        {
+            static_assert(is_forward_iterator<I>);
+            if constexpr(sizeof(*i1) == 1)
+            {
+                if(program_)
+                {
+                    auto last = program_->match(i1, i2);
+                    return make_result(bool(last), last ? *last : i1, i1);
+                }
+            }
+
+            if constexpr(is_bidirectional_iterator<I>)
+                return search(i1, find_end(i1, i2)); // std::regex needs the end iterator
+            else
+            {   // std::regex requires bidirectional iterators, match a copy of the input
+                std::basic_string<CharT> text(i1, find_end(i1, i2));
+                auto res = search(text.cbegin(), text.cend());
+                std::advance(i1, std::distance(text.cbegin(), res.position));
+                return make_result(res.matched, i1);
+            }
+        }
+
+        /// true if the regex is compiled to automata
+        bool compiled() const { return program_ != nullptr; }
+        const char* name() const { return "r_regex"; }
+    };
+
+    template<class CharT>
+    explicit r_regex(const CharT*)->r_regex<CharT>;
+
+    template<class CharT, class ST, class SA>
+    explicit r_regex(const std::basic_string<CharT, ST, SA>&)->r_regex<CharT>;
+
+    template<class CharT>
+    explicit r_regex(const CharT*, std::regex_constants::syntax_option_type)->r_regex<CharT>;
+
+    template<class CharT, class ST, class SA>
+    explicit r_regex(const std::basic_string<CharT, ST, SA>&, std::regex_constants::syntax_option_type)->r_regex<CharT>;
+
+    namespace detail
+    {
+        template<class CharT, class Traits>
+        struct iterator_independent_rule<r_regex<CharT, Traits>> : std::true_type {};
+    }
+}
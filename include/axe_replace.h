@@ -0,0 +1,372 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <functional>
+#include <type_traits>
+#include <cstring>
+#include "axe_trait.h"
+#include "axe_iterator.h"
+#include "axe_action.h"
+#include "axe_reflect.h"
+#include "axe_search.h"
+
+namespace axe
+{
+    namespace detail
+    {
+        template<class I>
+        struct search_match
+        {
+            bool matched;
+            I begin;
+            I end;
+        };
+
+        //-------------------------------------------------------------------------
+        // match_finder tries the rule at each position the same way as r_find,
+        // positions with elements not in the first set of the rule are skipped
+        //-------------------------------------------------------------------------
+        template<class R>
+        class match_finder
+        {
+            first_set_t first_;
+            bool skip_;
+            int single_ = -1; // the only byte starting a match
+
+        public:
+            explicit match_finder(const R& r) : first_(first_set(r)), skip_(!is_nullable(r) && !first_.all())
+            {
+                if(skip_ && first_.count() == 1)
+                    for(size_t c = 0; c < first_.size(); ++c)
+                        if(first_[c])
+                            single_ = static_cast<int>(c);
+            }
+
+            /// finds match starting at one of the next limit positions, or returns the position where search stopped
+            template<class I>
+            search_match<I> find(const R& r, I i, I i2, size_t limit) const
+            {
+                for(size_t n = 0; n < limit; ++n, ++i)
+                {
+                    if constexpr(sizeof(*i) == 1)
+                    {
+                        if(skip_)
+                        {
+                            if constexpr(is_contiguous_iterator<I>)
+                            {
+                                if(single_ >= 0 && i != i2)
+                                {
+                                    auto p = reinterpret_cast<const char*>(&*i);
+                                    auto found = static_cast<const char*>(std::memchr(p, single_, static_cast<size_t>(i2 - i)));
+                                    auto skip = found ? found - p : i2 - i;
+                                    i += skip;
+                                    n += static_cast<size_t>(skip);
+                                }
+                            }
+
+                            if(i == i2)
+                                return { false, i, i };
+                            if(!first_[static_cast<unsigned char>(*i)])
+                                continue;
+                        }
+                    }
+
+                    action_mark mark;
+                    auto res = r(i, i2);
+                    if(res.matched)
+                        return { true, i, res.position };
+                    mark.rollback();
+                    if(i == i2)
+                        return { false, i, i };
+                }
+                return { false, i, i };
+            }
+        };
+
+        // r_find_any locates the match itself, input is read up to the match
+        template<>
+        class match_finder<r_find_any>
+        {
+        public:
+            explicit match_finder(const r_find_any&) {}
+
+            template<class I>
+            search_match<I> find(const r_find_any& r, I i, I i2, size_t) const
+            {
+                auto res = r.search(i, i2);
+                if(!res.matched)
+                    return { false, i2, i2 };
+                return { true, res.data.second.begin(), res.data.second.end() };
+            }
+        };
+
+        template<class O>
+        struct back_inserted : std::false_type {};
+
+        template<class C>
+        struct back_inserted<std::back_insert_iterator<C>> : std::true_type
+        {
+            // back_insert_iterator keeps the container in protected member
+            struct access : std::back_insert_iterator<C>
+            {
+                static C& get(std::back_insert_iterator<C>& out) { return *(out.*&access::container); }
+            };
+        };
+
+        // copies range to output, containers are appended in bulk instead of push_back per element
+        template<class I, class O>
+        O copy_span(I i1, I i2, O out)
+        {
+            if constexpr(back_inserted<O>::value && is_forward_iterator<I>)
+            {
+                auto& c = back_inserted<O>::access::get(out);
+                c.insert(c.end(), i1, i2);
+                return out;
+            }
+            else
+                return std::copy(i1, i2, out);
+        }
+
+        template<class F, class I, class O>
+        O write_replacement(const F& f, I i1, I i2, O out)
+        {
+            if constexpr(std::is_invocable_v<const F&, I, I>)
+            {
+                if constexpr(std::is_void_v<std::invoke_result_t<const F&, I, I>>)
+                {
+                    std::invoke(f, i1, i2);
+                    return out;
+                }
+                else
+                    return write_replacement(std::invoke(f, i1, i2), i1, i2, out);
+            }
+            else if constexpr(std::is_array_v<F> || std::is_pointer_v<F>)
+            {   // C strings are copied without terminating zero
+                std::basic_string_view<std::remove_cv_t<std::remove_pointer_t<std::decay_t<F>>>> str(f);
+                return copy_span(str.begin(), str.end(), out);
+            }
+            else
+                return copy_span(std::begin(f), std::end(f), out);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// replace_result holds output iterator after the last written element and the number of replacements
+    //-------------------------------------------------------------------------
+    template<class O>
+    struct replace_result
+    {
+        O out;
+        size_t count;
+    };
+
+    namespace detail
+    {
+        template<class R, class I, class F, class O, class Release>
+        replace_result<O> replace_impl(const R& r, I i1, I i2, const F& replacement, O out, size_t limit, Release&& release)
+        {
+            match_finder<R> finder(r);
+            size_t count = 0;
+
+            for(auto i = i1;;)
+            {
+                auto m = finder.find(r, i, i2, limit);
+                out = copy_span(i, m.begin, out);
+                i = m.begin;
+
+                if(m.matched)
+                {
+                    out = write_replacement(replacement, m.begin, m.end, out);
+                    ++count;
+                    i = m.end;
+
+                    // empty match, the next element is copied to continue from another position
+                    if(m.begin == m.end)
+                    {
+                        if(i == i2)
+                            break;
+                        *out = *i;
+                        ++out;
+                        ++i;
+                    }
+                }
+                else if(i == i2)
+                    break;
+
+                release(i);
+            }
+
+            return { out, count };
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// replace copies input to output iterator, replacing text matched by rule,
+    /// replacement is either a range copied for each match, or a callback fn(i1, i2)
+    /// returning such range (or void to remove the match);
+    /// unmatched spans are copied in bulk, empty matches are replaced the same way as std::regex_replace;
+    /// input iterators are buffered and the buffer is released as output is written,
+    /// so memory is bounded by rule lookahead (r_find_any reads up to the next match)
+    //-------------------------------------------------------------------------
+    template<class R, class I, class F, class O>
+    replace_result<O> replace(const R& r, I i1, I i2, const F& replacement, O out)
+    {
+        if constexpr(is_forward_iterator<I>)
+            return detail::replace_impl(r, i1, i2, replacement, out, size_t(-1), [](auto&) {});
+        else
+        {
+            constexpr size_t chunk = 4096; // positions searched between buffer releases
+            input_buffer<I> buf(i1, i2);
+            return detail::replace_impl(r, buf.begin(), buf.end(), replacement, out, chunk,
+                [&](auto& i) { buf.release(i); });
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    template<class R, class Txt, class F, class O>
+    replace_result<O> replace(const R& r, const Txt& txt, const F& replacement, O out)
+    {
+        return replace(r, std::begin(txt), std::end(txt), replacement, out);
+    }
+
+    //-------------------------------------------------------------------------
+    /// match_range is a lazy forward range of matches of the rule in the input;
+    /// the next match is searched when iterator is incremented, matches are not stored,
+    /// iterators refer to the range, which must outlive them, as well as the input
+    //-------------------------------------------------------------------------
+    template<class R, class I>
+    class match_range
+    {
+        R r_;
+        I begin_;
+        I end_;
+        detail::match_finder<R> finder_;
+
+    public:
+        class iterator
+        {
+            const match_range* range_ = nullptr; // end iterator has no range
+            it_pair<I> match_;
+
+            void find(I i)
+            {
+                auto m = range_->finder_.find(range_->r_, i, range_->end_, size_t(-1));
+                if(m.matched)
+                    match_ = it_pair<I>(m.begin, m.end);
+                else
+                    range_ = nullptr;
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = it_pair<I>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const it_pair<I>*;
+            using reference = const it_pair<I>&;
+
+            iterator() = default;
+            iterator(const match_range* range, I i) : range_(range) { find(i); }
+
+            reference operator* () const { return match_; }
+            pointer operator-> () const { return &match_; }
+
+            iterator& operator++ ()
+            {
+                // empty match doesn't advance, the search continues from the next position
+                auto i = match_.end();
+                if(match_.empty())
+                {
+                    if(i == range_->end_)
+                    {
+                        range_ = nullptr;
+                        return *this;
+                    }
+                    ++i;
+                }
+                find(i);
+                return *this;
+            }
+
+            iterator operator++ (int) { auto tmp = *this; ++*this; return tmp; }
+
+            bool operator== (const iterator& other) const
+            {
+                return range_ == other.range_ && (!range_ || (match_.begin() == other.match_.begin() && match_.end() == other.match_.end()));
+            }
+            bool operator!= (const iterator& other) const { return !operator==(other); }
+        };
+
+        template<class T>
+        match_range(T&& r, I begin, I end) : r_(std::forward<T>(r)), begin_(begin), end_(end), finder_(r_) {}
+
+        iterator begin() const { return iterator(this, begin_); }
+        iterator end() const { return iterator(); }
+    };
+
+    //-------------------------------------------------------------------------
+    /// matches returns lazy range of it_pair for each match of the rule, positions between matches
+    /// are skipped the same way as in replace; the rule is copied, the input is referenced
+    //-------------------------------------------------------------------------
+    template<class R, class I>
+    auto matches(R&& r, I begin, I end)
+    {
+        static_assert(is_forward_iterator<I>);
+        return match_range<std::decay_t<R>, I>(std::forward<R>(r), begin, end);
+    }
+
+    namespace detail
+    {
+        // text referenced by match_range must outlive it: lvalue or a view of other text
+        template<class Txt>
+        constexpr bool is_borrowed_text_v = std::is_lvalue_reference_v<Txt>;
+
+        template<class CharT, class Traits>
+        constexpr bool is_borrowed_text_v<std::basic_string_view<CharT, Traits>> = true;
+
+        template<class I>
+        constexpr bool is_borrowed_text_v<it_pair<I>> = true;
+    }
+
+    //-------------------------------------------------------------------------
+    template<class R, class Txt, class = std::enable_if_t<detail::is_borrowed_text_v<Txt>>>
+    auto matches(R&& r, Txt&& txt)
+    {
+        return matches(std::forward<R>(r), std::begin(txt), std::end(txt));
+    }
+
+    /// temporary text would be destroyed before the matches are found
+    template<class R, class Txt, class = std::enable_if_t<!detail::is_borrowed_text_v<Txt>>, class = void>
+    auto matches(R&&, Txt&&) = delete;
+}
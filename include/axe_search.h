@@ -0,0 +1,312 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <map>
+#include <string_view>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include "axe_trait.h"
+#include "axe_result.h"
+#include "axe_iterator.h"
+#include "axe_detail.h"
+
+namespace axe
+{
+    namespace detail
+    {
+        //-------------------------------------------------------------------------
+        // aho_corasick is a multi-pattern automaton over bytes;
+        // states are numbered in breadth first order, edges of each state are stored
+        // contiguously and sorted by byte, the root has a dense transition table
+        //-------------------------------------------------------------------------
+        class aho_corasick
+        {
+        public:
+            static constexpr size_t npos = size_t(-1);
+
+            /// leftmost match, patterns starting at the same position are ordered by index
+            struct match
+            {
+                size_t pattern = npos;
+                size_t begin = 0; // offset of the first matched element
+                size_t end = 0;   // offset after the last matched element
+            };
+
+        private:
+            using edge = std::pair<unsigned char, uint32_t>;
+
+            std::vector<uint32_t> first_edge_{ 0, 0 }; // edges of state s are [first_edge_[s], first_edge_[s + 1])
+            std::vector<edge> edges_;
+            std::vector<uint32_t> fail_{ 0 };
+            std::vector<uint32_t> dict_{ 0 };      // next state with output on the fail chain, 0 if none
+            std::vector<size_t> output_{ npos };   // the smallest index of pattern ending in the state
+            std::vector<uint32_t> depth_{ 0 };
+            std::vector<size_t> lengths_;
+            std::array<uint32_t, 256> root_{};
+            std::array<bool, 256> first_{};        // bytes starting a pattern
+            size_t first_count_ = 0;
+            int first_byte_ = -1;                  // the start byte when all patterns start with it
+            size_t empty_ = npos;                  // the smallest index of empty pattern
+
+            uint32_t child(uint32_t s, unsigned char c) const
+            {
+                auto b = edges_.begin() + first_edge_[s];
+                auto e = edges_.begin() + first_edge_[s + 1];
+                auto it = std::lower_bound(b, e, c, [](const edge& x, unsigned char c) { return x.first < c; });
+                return it != e && it->first == c ? it->second : 0;
+            }
+
+            uint32_t next(uint32_t s, unsigned char c) const
+            {
+                for(; s != 0; s = fail_[s])
+                {
+                    if(auto t = child(s, c))
+                        return t;
+                }
+                return root_[c];
+            }
+
+            void report(uint32_t s, size_t end, match& m) const
+            {
+                for(s = output_[s] != npos ? s : dict_[s]; s != 0; s = dict_[s])
+                {
+                    auto begin = end - lengths_[output_[s]];
+                    if(m.pattern == npos || begin < m.begin || (begin == m.begin && output_[s] < m.pattern))
+                        m = match{ output_[s], begin, end };
+                }
+            }
+
+        public:
+            aho_corasick() = default;
+
+            template<class Patterns>
+            explicit aho_corasick(const Patterns& patterns)
+            {
+                // trie with ordered children, renumbered breadth first below
+                std::vector<std::map<unsigned char, uint32_t>> trie(1);
+                std::vector<size_t> output(1, npos);
+                for(auto& p : patterns)
+                {
+                    std::string_view str(p);
+                    auto index = lengths_.size();
+                    lengths_.push_back(str.size());
+
+                    uint32_t s = 0;
+                    for(auto c : str)
+                    {
+                        auto [it, inserted] = trie[s].emplace(static_cast<unsigned char>(c), static_cast<uint32_t>(trie.size()));
+                        if(inserted)
+                        {
+                            trie.emplace_back();
+                            output.push_back(npos);
+                        }
+                        s = it->second;
+                    }
+
+                    if(s == 0)
+                        empty_ = std::min(empty_, index);
+                    else
+                        output[s] = std::min(output[s], index);
+                }
+
+                std::vector<uint32_t> order(1, 0), number(trie.size(), 0);
+                for(size_t i = 0; i < order.size(); ++i)
+                {
+                    for(auto& [c, t] : trie[order[i]])
+                    {
+                        number[t] = static_cast<uint32_t>(order.size());
+                        order.push_back(t);
+                    }
+                }
+
+                auto size = trie.size();
+                first_edge_.assign(size + 1, 0);
+                fail_.assign(size, 0);
+                dict_.assign(size, 0);
+                output_.assign(size, npos);
+                depth_.assign(size, 0);
+                edges_.reserve(size - 1);
+                for(size_t s = 0; s < size; ++s)
+                {
+                    first_edge_[s] = static_cast<uint32_t>(edges_.size());
+                    output_[s] = output[order[s]];
+                    for(auto& [c, t] : trie[order[s]])
+                    {
+                        edges_.emplace_back(c, number[t]);
+                        depth_[number[t]] = depth_[s] + 1;
+                    }
+                }
+                first_edge_[size] = static_cast<uint32_t>(edges_.size());
+
+                for(auto& [c, t] : trie[0])
+                {
+                    root_[c] = number[t];
+                    first_[c] = true;
+                    ++first_count_;
+                }
+                if(first_count_ == 1)
+                    first_byte_ = trie[0].begin()->first;
+
+                // children are processed after parents, so fail links of shorter prefixes are ready
+                for(uint32_t s = 0; s < size; ++s)
+                {
+                    for(auto e = first_edge_[s]; e < first_edge_[s + 1]; ++e)
+                    {
+                        auto [c, t] = edges_[e];
+                        auto f = s == 0 ? 0 : next(fail_[s], c);
+                        fail_[t] = f;
+                        dict_[t] = output_[f] != npos ? f : dict_[f];
+                    }
+                }
+            }
+
+            size_t size() const { return lengths_.size(); }
+            size_t length(size_t pattern) const { return lengths_[pattern]; }
+            bool has_empty() const { return empty_ != npos; }
+
+            /// finds the leftmost match, the same as ordered choice of patterns tried at each position
+            template<class Iterator, class Iterator2>
+            match find(Iterator i1, Iterator2 i2) const
+            {
+                static_assert(is_forward_iterator<Iterator>);
+                static_assert(sizeof(*i1) == 1, "aho_corasick matches byte sequences");
+
+                match m;
+                if(empty_ != npos)
+                    m = match{ empty_, 0, 0 };
+
+                uint32_t s = 0;
+                size_t offset = 0;
+                for(auto i = i1; i != i2; ++i, ++offset)
+                {
+                    // matches ending later start at or after offset - depth
+                    if(m.pattern != npos && offset - depth_[s] > m.begin)
+                        break;
+
+                    if(s == 0)
+                    {
+                        // prefilter skips bytes which can't start a pattern,
+                        // memchr is used when the start byte is not among the next few bytes
+                        if constexpr(is_contiguous_iterator<Iterator> && std::is_same_v<Iterator, Iterator2>)
+                        {
+                            constexpr size_t table_scan = 16;
+                            for(size_t k = 0; k < table_scan && i != i2 && !first_[static_cast<unsigned char>(*i)]; ++k, ++i, ++offset);
+
+                            if(first_byte_ >= 0 && i != i2 && !first_[static_cast<unsigned char>(*i)])
+                            {
+                                auto p = static_cast<const char*>(std::memchr(&*i, first_byte_, static_cast<size_t>(i2 - i)));
+                                if(!p)
+                                    break;
+                                auto skip = static_cast<size_t>(p - reinterpret_cast<const char*>(&*i));
+                                i += skip;
+                                offset += skip;
+                            }
+                        }
+
+                        for(; i != i2 && !first_[static_cast<unsigned char>(*i)]; ++i, ++offset);
+                        if(i == i2 || (m.pattern != npos && offset > m.begin))
+                            break;
+                    }
+
+                    s = next(s, static_cast<unsigned char>(*i));
+                    if(output_[s] != npos || dict_[s] != 0)
+                        report(s, offset + 1, m);
+                }
+                return m;
+            }
+        };
+    }
+
+    //-------------------------------------------------------------------------
+    /// r_find_any skips input elements until one of the literal patterns is matched,
+    /// which is the same as r_find(lit1 | lit2 | ...), but uses Aho-Corasick automaton
+    /// and scans input once; patterns are searched in byte sequences,
+    /// parse tree data is the index of matched pattern and the matched range
+    //-------------------------------------------------------------------------
+    class r_find_any final
+    {
+        std::shared_ptr<const detail::aho_corasick> ac_;
+
+    public:
+        template<class Patterns, class = detail::disable_copy<Patterns, r_find_any>>
+        explicit r_find_any(const Patterns& patterns)
+            : ac_(std::make_shared<const detail::aho_corasick>(patterns))
+        {}
+
+        explicit r_find_any(std::initializer_list<std::string_view> patterns)
+            : ac_(std::make_shared<const detail::aho_corasick>(patterns))
+        {}
+
+        /// returns the index of matched pattern and the matched range as data
+        template<class Iterator, class Iterator2>
+        auto search(Iterator i1, Iterator2 i2) const
+        {
+            using data_t = std::pair<size_t, it_pair<Iterator>>;
+            auto m = ac_->find(i1, i2);
+            if(m.pattern == detail::aho_corasick::npos)
+                return result<Iterator, data_t>(data_t(m.pattern, it_pair(i1, i1)), false, i1);
+
+            auto begin = std::next(i1, m.begin);
+            auto end = std::next(begin, m.end - m.begin);
+            return result<Iterator, data_t>(data_t(m.pattern, it_pair(begin, end)), true, end);
+        }
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            auto res = search(i1, i2);
+            return result(res.matched, res.position);
+        }
+
+        template<class Iterator>
+        auto operator() (it_pair<Iterator> itp) const
+        {
+            return search(itp.begin(), itp.end());
+        }
+
+        size_t size() const { return ac_->size(); }
+        bool has_empty() const { return ac_->has_empty(); }
+        const char* name() const { return "r_find_any"; }
+    };
+
+    namespace detail
+    {
+        template<>
+        struct iterator_independent_rule<r_find_any> : std::true_type {};
+    }
+}
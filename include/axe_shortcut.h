@@ -32,6 +32,7 @@
 #include "axe_composite_function.h"
 #include "axe_predicate_function.h"
 #include "axe_numeric_function.h"
+#include "axe_regex.h"
 
 namespace axe
 {
@@ -86,6 +87,18 @@ namespace axe
             return axe::r_char(c);
         }
 
+        //---------------------------------------
+        inline auto operator "" _iaxe(const char* str, size_t size)
+        {
+            return axe::r_istr(std::string_view(str, size));
+        }
+
+        //---------------------------------------
+        inline auto operator "" _iaxe(const wchar_t* str, size_t size)
+        {
+            return axe::r_istr(std::wstring_view(str, size));
+        }
+
         //---------------------------------------
         inline auto operator "" _any(const char* str, size_t)
         {
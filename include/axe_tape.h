@@ -0,0 +1,207 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include "axe_trait.h"
+#include "axe_detail.h"
+#include "axe_result.h"
+#include "axe_iterator.h"
+#include "axe_action.h"
+
+namespace axe
+{
+    //-------------------------------------------------------------------------
+    /// tape_event is a fixed size record written by r_tape rules
+    /// offsets are relative to the beginning of parsed text
+    //-------------------------------------------------------------------------
+    struct tape_event
+    {
+        const char* tag;
+        size_t begin;
+        size_t end;
+    };
+
+    //-------------------------------------------------------------------------
+    /// event_tape is a contiguous preallocated buffer of tape_event records
+    /// events are written in the order rules start matching (parent before children),
+    /// events of failed alternatives are truncated when the tape is active (see parse_tape)
+    //-------------------------------------------------------------------------
+    template<class I>
+    class event_tape final : public detail::action_log_base
+    {
+        static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+            typename std::iterator_traits<I>::iterator_category>, "event_tape requires random access iterator");
+
+        std::vector<tape_event> events_;
+        I base_{};
+
+    public:
+        using const_iterator = typename std::vector<tape_event>::const_iterator;
+
+        event_tape() = default;
+        explicit event_tape(size_t capacity) { events_.reserve(capacity); }
+        event_tape(const event_tape&) = delete;
+        event_tape& operator= (const event_tape&) = delete;
+
+        size_t size() const override { return events_.size(); }
+        void truncate(size_t size) override { events_.resize(std::min(size, events_.size())); }
+
+        /// true when the tape is recording events with backtracking in this thread
+        bool active() const { return detail::active_action_log == this; }
+
+        /// discards events and sets the origin for event offsets
+        void reset(I base)
+        {
+            events_.clear();
+            base_ = base;
+        }
+
+        I base() const { return base_; }
+        bool empty() const { return events_.empty(); }
+        const_iterator begin() const { return events_.begin(); }
+        const_iterator end() const { return events_.end(); }
+        const tape_event& operator[] (size_t index) const { return events_[index]; }
+
+        /// opens event at position i, returns event index
+        size_t open(const char* tag, I i)
+        {
+            auto offset = static_cast<size_t>(i - base_);
+            events_.push_back(tape_event{ tag, offset, offset });
+            return events_.size() - 1;
+        }
+
+        /// closes event opened at index
+        void close(size_t index, I i) { events_[index].end = static_cast<size_t>(i - base_); }
+
+        /// writes complete event
+        void push(const char* tag, I i1, I i2)
+        {
+            events_.push_back(tape_event{ tag, static_cast<size_t>(i1 - base_), static_cast<size_t>(i2 - base_) });
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    /// r_tape_t rule writes tape_event for matched rule R
+    /// the event is opened before R is matched, so nested events follow it on the tape
+    //-------------------------------------------------------------------------
+    template<class R, class I>
+    class r_tape_t final
+    {
+        R r_;
+        event_tape<I>& tape_;
+        const char* tag_;
+    public:
+        template<class RR>
+        r_tape_t(RR&& r, event_tape<I>& tape, const char* tag) : r_(std::forward<RR>(r)), tape_(tape), tag_(tag) {}
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            static_assert(std::is_convertible_v<Iterator, I>, "iterator type must match event_tape");
+
+            auto index = tape_.open(tag_, i1);
+            auto match = r_(i1, i2);
+            if(match.matched)
+                tape_.close(index, match.position);
+            else
+                tape_.truncate(index);
+            return match;
+        }
+
+        const char* name() const { return tag_; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// e_tape_t extractor writes tape_event for matched text
+    //-------------------------------------------------------------------------
+    template<class I>
+    class e_tape_t
+    {
+        event_tape<I>& tape_;
+        const char* tag_;
+    public:
+        e_tape_t(event_tape<I>& tape, const char* tag) : tape_(tape), tag_(tag) {}
+
+        template<class Iterator>
+        void operator() (Iterator i1, Iterator i2) const
+        {
+            static_assert(std::is_convertible_v<Iterator, I>, "iterator type must match event_tape");
+            tape_.push(tag_, i1, i2);
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    /// function r_tape creates rule writing events tagged with rule name (e.g. r_named)
+    //-------------------------------------------------------------------------
+    template<class R, class I>
+    inline r_tape_t<detail::enable_if_rule<R>, I> r_tape(event_tape<I>& tape, R&& r)
+    {
+        static_assert(has_name<std::decay_t<R>>::value, "rule must have a name, use r_named");
+        const char* tag = r.name();
+        return r_tape_t<std::decay_t<R>, I>(std::forward<R>(r), tape, tag);
+    }
+
+    //-------------------------------------------------------------------------
+    /// function r_tape creates rule writing events with specified tag
+    //-------------------------------------------------------------------------
+    template<class R, class I>
+    inline r_tape_t<detail::enable_if_rule<R>, I> r_tape(event_tape<I>& tape, R&& r, const char* tag)
+    {
+        return r_tape_t<std::decay_t<R>, I>(std::forward<R>(r), tape, tag);
+    }
+
+    //-------------------------------------------------------------------------
+    /// function e_tape creates extractor writing events with specified tag
+    //-------------------------------------------------------------------------
+    template<class I>
+    inline e_tape_t<I> e_tape(event_tape<I>& tape, const char* tag)
+    {
+        return e_tape_t<I>(tape, tag);
+    }
+
+    //-------------------------------------------------------------------------
+    /// make_it_pair converts tape_event to it_pair, base is the beginning of parsed text
+    //-------------------------------------------------------------------------
+    template<class I>
+    auto make_it_pair(const tape_event& event, I base)
+    {
+        return it_pair<I>(base + event.begin, base + event.end);
+    }
+
+    template<class I>
+    auto make_it_pair(const event_tape<I>& tape, const tape_event& event)
+    {
+        return make_it_pair(event, tape.base());
+    }
+}
@@ -29,19 +29,24 @@
 #pragma once
 
 #include <array>
+#include <algorithm>
 #include <iterator>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <cstring>
+#include <cstdint>
 #include <math.h>
 #include <utility>
+#include <memory>
 #include <stddef.h>
-#include <regex>
 
 #include "axe_trait.h"
 #include "axe_result.h"
 #include "axe_predicate.h"
 #include "axe_composite.h"
 #include "axe_iterator.h"
+#include "axe_context.h"
 
 namespace axe
 {
@@ -96,8 +101,8 @@ namespace axe
     //-------------------------------------------------------------------------
     struct r_empty final
     {
-        template<class Iterator>
-        result<Iterator> operator() (Iterator i1, Iterator) const
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2) const
         {
             static_assert(is_input_iterator<Iterator>);
             return result(true, i1);
@@ -126,6 +131,7 @@ namespace axe
             return i1 != i2 && t == *i1 ? result(true, std::next(i1)) : result(false, i1);
         }
 
+        const CharT& value() const { return t; }
         const char* name() const { return "r_char"; }
     };
 
@@ -253,6 +259,76 @@ namespace axe
     template<class CharT, class TraitsT, class AllocT>
     explicit r_str(const std::basic_string<CharT, TraitsT, AllocT>&)->r_str<std::basic_string<CharT, TraitsT, AllocT>>;
 
+    //-------------------------------------------------------------------------
+    /// rule to perform ASCII case insensitive match, the string is folded once,
+    /// input element is compared after setting bit 5 for letters only,
+    /// contiguous char input is compared 8 elements at a time;
+    /// use r_icase for locale aware case folding
+    //-------------------------------------------------------------------------
+    template<class CharT>
+    class r_istr final
+    {
+        static_assert(!AXE_IS_RULE(CharT));
+        std::basic_string<CharT> str_; // lower case string
+        std::basic_string<CharT> mask_; // 0x20 for letters, 0 for other characters
+
+    public:
+        explicit r_istr(std::basic_string_view<CharT> str) : str_(str), mask_(str.size(), CharT(0))
+        {
+            for(size_t i = 0; i < str_.size(); ++i)
+            {
+                if((str_[i] >= 'A' && str_[i] <= 'Z') || (str_[i] >= 'a' && str_[i] <= 'z'))
+                {
+                    str_[i] |= 0x20;
+                    mask_[i] = 0x20;
+                }
+            }
+        }
+
+        explicit r_istr(const CharT* str) : r_istr(str ? std::basic_string_view<CharT>(str) : std::basic_string_view<CharT>()) {}
+
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            static_assert(is_input_iterator<Iterator>);
+            static_assert(std::is_convertible<decltype(*i1), CharT>::value);
+            size_t s = 0;
+            const size_t size = str_.size();
+
+            if constexpr(sizeof(CharT) == 1 && sizeof(*i1) == 1 && is_contiguous_iterator<Iterator> && std::is_same_v<Iterator, Iterator2>)
+            {
+                if(size >= sizeof(uint64_t) && size_t(i2 - i1) >= size)
+                {
+                    const auto* p = reinterpret_cast<const char*>(&*i1);
+                    for(; s + sizeof(uint64_t) <= size; s += sizeof(uint64_t))
+                    {
+                        uint64_t input, mask, str;
+                        std::memcpy(&input, p + s, sizeof(uint64_t));
+                        std::memcpy(&mask, mask_.data() + s, sizeof(uint64_t));
+                        std::memcpy(&str, str_.data() + s, sizeof(uint64_t));
+                        if((input | mask) != str)
+                            break;
+                    }
+                    i1 += s;
+                }
+            }
+
+            // remaining elements, or the first mismatch position
+            for(; s < size && i1 != i2 && (*i1 | mask_[s]) == str_[s]; ++s, ++i1);
+            return make_result(s == size, i1);
+        }
+
+        const std::basic_string<CharT>& str() const { return str_; }
+        const char* name() const { return "r_istr"; }
+    };
+
+    template<class CharT>
+    explicit r_istr(const CharT*)->r_istr<CharT>;
+    template<class CharT, class TraitsT, class AllocT>
+    explicit r_istr(const std::basic_string<CharT, TraitsT, AllocT>&)->r_istr<CharT>;
+    template<class CharT, class TraitsT>
+    explicit r_istr(std::basic_string_view<CharT, TraitsT>)->r_istr<CharT>;
+
     //-------------------------------------------------------------------------
     /// rule matches a single element satisfying predicate
     //-------------------------------------------------------------------------
@@ -272,12 +348,43 @@ namespace axe
             return i1 != i2 && pred_(*i1) ? result(true, std::next(i1)) : result(false, i1);
         }
 
+        const Pred& predicate() const { return pred_; }
         const char* name() const { return "r_pred"; }
     };
 
     template<class Pred>
     r_pred(Pred&&)->r_pred<std::decay_t<Pred>>;
     
+    namespace detail
+    {
+        template<class CharT>
+        struct single_element_rule<r_char<CharT>> : std::true_type
+        {
+            static constexpr bool any = false;
+
+            template<class V>
+            static bool test(const r_char<CharT>& r, const V& v) { return r.value() == v; }
+        };
+
+        template<auto C>
+        struct single_element_rule<r_strlit<C>> : std::true_type
+        {
+            static constexpr bool any = false;
+
+            template<class V>
+            static bool test(const r_strlit<C>&, const V& v) { return C == v; }
+        };
+
+        template<class Pred>
+        struct single_element_rule<r_pred<Pred>> : std::true_type
+        {
+            static constexpr bool any = std::is_same_v<Pred, is_any_t<void>>;
+
+            template<class V>
+            static bool test(const r_pred<Pred>& r, const V& v) { return r.predicate()(v); }
+        };
+    }
+
     //-------------------------------------------------------------------------
     /// rule matches a string of elements satisfying predicate
     //-------------------------------------------------------------------------
@@ -299,6 +406,7 @@ namespace axe
             return make_result(i != i1, i);
         }
 
+        const Pred& predicate() const { return pred_; }
         const char* name() const { return "r_predstr"; }
     };
 
@@ -338,6 +446,10 @@ namespace axe
             return make_result(count >= min_occurrence_, i);
         }
 
+        const Pred& predicate() const { return pred_; }
+        size_t min_occurrence() const { return min_occurrence_; }
+        size_t max_occurrence() const { return max_occurrence_; }
+
         std::string name() const
         {
             std::ostringstream ss("r_predstr(pred, ");
@@ -351,17 +463,84 @@ namespace axe
     template<class Pred>
     r_predstr(Pred&&, size_t, size_t)->r_predstr<std::decay_t<Pred>, true>;
 
+    //-------------------------------------------------------------------------
+    /// byte order of binary values in the input
+    //-------------------------------------------------------------------------
+    enum class byte_order { native, little, big };
+
+    namespace detail
+    {
+        constexpr bool is_little_endian_v =
+#if defined(__BYTE_ORDER__)
+            __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+#else
+            true; // windows targets are little endian
+#endif
+
+        // values in the specified byte order must be byte swapped on this platform
+        template<byte_order Order>
+        constexpr bool needs_byte_swap_v = Order != byte_order::native
+            && (Order == byte_order::little) != is_little_endian_v;
+
+        // contiguous byte input, binary values are copied with memcpy
+        template<class I, class I2>
+        constexpr bool is_contiguous_bytes_v = std::is_same_v<I, I2> && is_contiguous_iterator<I>
+            && sizeof(typename std::iterator_traits<I>::value_type) == 1;
+
+        template<class C, class T, class = void>
+        constexpr bool has_resizable_data_v = false;
+
+        template<class C, class T>
+        constexpr bool has_resizable_data_v<C, T, std::void_t<decltype(std::declval<C&>().resize(0)),
+            decltype(std::declval<C&>().data())>> = std::is_same_v<decltype(std::declval<C&>().data()), T*>;
+
+        template<class C, class = void>
+        constexpr bool has_reserve_v = false;
+
+        template<class C>
+        constexpr bool has_reserve_v<C, std::void_t<decltype(std::declval<C&>().reserve(0))>> = true;
+
+        // appends count values of type T stored in bytes to container
+        template<class T, class C>
+        void append_values(C& c, const void* bytes, size_t count)
+        {
+            if constexpr(has_resizable_data_v<C, T>)
+            {
+                auto size = c.size();
+                c.resize(size + count);
+                std::memcpy(std::data(c) + size, bytes, count * sizeof(T));
+            }
+            else
+            {
+                if constexpr(has_reserve_v<C>)
+                    c.reserve(c.size() + count);
+
+                auto p = static_cast<const unsigned char*>(bytes);
+                for(size_t i = 0; i < count; ++i, p += sizeof(T))
+                {
+                    T t;
+                    std::memcpy(&t, p, sizeof(T));
+                    c.push_back(std::move(t));
+                }
+            }
+        }
+    }
+
     //-------------------------------------------------------------------------
     /// r_var rule matches a variable of type T (binary) and reads its value
+    /// T can be a slot of parse context, Order specifies byte order of arithmetic values
     //-------------------------------------------------------------------------
-    template<class T>
+    template<class T, byte_order Order = byte_order::native>
     class r_var final 
     {
-        static_assert(std::is_standard_layout_v<T> && std::is_trivially_constructible_v<T>);
-        T& t;
+        using value_type = detail::bound_t<T>;
+        static_assert(std::is_standard_layout_v<value_type> && std::is_trivially_constructible_v<value_type>);
+        static_assert(Order == byte_order::native || std::is_arithmetic_v<value_type> || std::is_enum_v<value_type>,
+            "byte order conversion requires arithmetic or enum type");
+        detail::binding<T> t;
 
     public:
-        explicit r_var(T& t) : t(t) {}
+        explicit r_var(detail::binding<T> t) : t(t) {}
 
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
@@ -369,12 +548,29 @@ namespace axe
             static_assert(is_input_iterator<Iterator>);
             static_assert(sizeof(*i1) == 1, "iterator must be byte size for binary match");
 
-            unsigned char* c = reinterpret_cast<unsigned char*>(&t);
-            unsigned s = 0;
-            for(; s < sizeof(T) && i1 != i2; ++i1, ++s)
-                c[s] = *i1;
+            unsigned char* c = reinterpret_cast<unsigned char*>(&t.get());
+            if constexpr(detail::is_contiguous_bytes_v<Iterator, Iterator2>)
+            {
+                if(size_t(i2 - i1) < sizeof(value_type))
+                    return make_result(false, i2);
+
+                std::memcpy(c, std::addressof(*i1), sizeof(value_type));
+                i1 += sizeof(value_type);
+            }
+            else
+            {
+                unsigned s = 0;
+                for(; s < sizeof(value_type) && i1 != i2; ++i1, ++s)
+                    c[s] = *i1;
 
-            return make_result(s == sizeof(T), i1);
+                if(s != sizeof(value_type))
+                    return make_result(false, i1);
+            }
+
+            if constexpr(detail::needs_byte_swap_v<Order>)
+                std::reverse(c, c + sizeof(value_type));
+
+            return make_result(true, i1);
         }
 
         const char* name() const { return "r_var"; }
@@ -382,33 +578,61 @@ namespace axe
 
     template<class T>
     explicit r_var(T&)->r_var<std::decay_t<T>>;
+    template<class Ctx, class T>
+    explicit r_var(slot<Ctx, T>)->r_var<slot<Ctx, T>>;
+
+    //-------------------------------------------------------------------------
+    /// r_var_be and r_var_le match arithmetic values stored in big and little endian order
+    //-------------------------------------------------------------------------
+    template<class T>
+    auto r_var_be(T& t) { return r_var<std::decay_t<T>, byte_order::big>(t); }
+    template<class Ctx, class T>
+    auto r_var_be(slot<Ctx, T> s) { return r_var<slot<Ctx, T>, byte_order::big>(s); }
+
+    template<class T>
+    auto r_var_le(T& t) { return r_var<std::decay_t<T>, byte_order::little>(t); }
+    template<class Ctx, class T>
+    auto r_var_le(slot<Ctx, T> s) { return r_var<slot<Ctx, T>, byte_order::little>(s); }
 
     //-------------------------------------------------------------------------
     /// r_array rule reads values to a static array
+    /// A is either std::array<T, N> or a slot of parse context of that type
     //-------------------------------------------------------------------------
-    template<class T, size_t N>
+    template<class T, size_t N, class A = std::array<T, N>>
     class r_array final 
     {
         static_assert(std::is_standard_layout_v<T>);
-        std::array<T, N>& buf_;
+        static_assert(std::is_same_v<detail::bound_t<A>, std::array<T, N>>);
+        detail::binding<A> buf_;
 
     public:
-        explicit r_array(std::array<T, N>& a) : buf_(a) {}
+        explicit r_array(detail::binding<A> a) : buf_(a) {}
 
         template<class Iterator, class Iterator2>
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
         {
             static_assert(is_forward_iterator<Iterator>);
-            size_t s = 0;
+            auto& buf = buf_.get();
 
-            for(bool matched = true; matched && s < N && i1 != i2; ++s)
+            if constexpr(detail::is_contiguous_bytes_v<Iterator, Iterator2>)
             {
-                r_var<T> tmp(buf_[s]);
+                if(size_t(i2 - i1) >= sizeof(buf))
+                {
+                    std::memcpy(buf.data(), std::addressof(*i1), sizeof(buf));
+                    return make_result(true, i1 + sizeof(buf));
+                }
+            }
+
+            size_t s = 0;
+            for(; s < N && i1 != i2; ++s)
+            {
+                r_var<T> tmp(buf[s]);
 
                 auto&& result = tmp(i1, i2);
 
                 i1 = result.position;
-                matched = result.matched;
+                if(!result.matched)
+                    break;
             }
 
             return make_result(s == N, i1);
@@ -419,25 +643,32 @@ namespace axe
 
     template<class T, size_t N>
     explicit r_array(std::array<T, N>&)->r_array<std::decay_t<T>, N>;
+    template<class Ctx, class T, size_t N>
+    explicit r_array(slot<Ctx, std::array<T, N>>)->r_array<T, N, slot<Ctx, std::array<T, N>>>;
 
     //-------------------------------------------------------------------------
     /// r_sequence rule reads sequence of specified length
+    /// container bound to a variable is cleared at construction,
+    /// container bound to a slot of parse context is cleared before matching
+    /// incomplete trailing element is not consumed
     //-------------------------------------------------------------------------
-    template<class C, typename = decltype(std::declval<C>().push_back(std::declval<typename C::value_type>()))>
+    template<class C, typename = decltype(std::declval<detail::bound_t<C>&>().push_back(
+        std::declval<typename detail::bound_t<C>::value_type>()))>
     class r_sequence final 
     {
-        using T = typename C::value_type;
+        using T = typename detail::bound_t<C>::value_type;
         static_assert(std::is_standard_layout_v<T> && std::is_trivially_constructible_v<T>);
-        C& buf_;
+        detail::binding<C> buf_;
         const size_t min_occurrence_;
         const size_t max_occurrence_;
 
     public:
         //----------------------------
-        r_sequence(C& buf, size_t min_occurrence, size_t max_occurrence)
+        r_sequence(detail::binding<C> buf, size_t min_occurrence, size_t max_occurrence)
             : buf_(buf), min_occurrence_(min_occurrence), max_occurrence_(max_occurrence)
         {
-            buf_.clear();
+            if constexpr(!is_slot_v<C>)
+                buf_.get().clear();
         }
 
         //----------------------------
@@ -445,19 +676,31 @@ namespace axe
         result<Iterator> operator() (Iterator i1, Iterator2 i2) const
         {
             static_assert(is_forward_iterator<Iterator>);
-            size_t s = 0;
+            auto& buf = buf_.get();
+            if constexpr(is_slot_v<C>)
+                buf.clear();
 
-            for(bool matched = true; matched && i1 != i2 && s < max_occurrence_; ++s)
+            if constexpr(detail::is_contiguous_bytes_v<Iterator, Iterator2>)
             {
-                T t;
-                auto&& r = r_var<T>(t)(i1, i2);
-                i1 = r.position;
-                matched = r.matched;
-                if(matched)
-                    buf_.push_back(std::move(t));
+                auto count = std::min(max_occurrence_, size_t(i2 - i1) / sizeof(T));
+                detail::append_values<T>(buf, count ? std::addressof(*i1) : nullptr, count);
+                i1 += count * sizeof(T);
             }
+            else
+            {
+                for(size_t s = 0; i1 != i2 && s < max_occurrence_; ++s)
+                {
+                    T t;
+                    auto&& r = r_var<T>(t)(i1, i2);
+                    if(!r.matched)
+                        break;
 
-            return make_result(buf_.size() >= min_occurrence_, i1);
+                    i1 = r.position;
+                    buf.push_back(std::move(t));
+                }
+            }
+
+            return make_result(buf.size() >= min_occurrence_, i1);
         }
 
         const char* name() const { return "r_sequence"; }
@@ -465,6 +708,8 @@ namespace axe
 
     template<class C>
     r_sequence(C&, size_t = 0, size_t = -1)->r_sequence<C>;
+    template<class Ctx, class C>
+    r_sequence(slot<Ctx, C>, size_t = 0, size_t = -1)->r_sequence<slot<Ctx, C>>;
 
     //-------------------------------------------------------------------------
     /// r_ident rule matches identifier (letter followed by letters and digits)
@@ -504,7 +749,23 @@ namespace axe
     };
 
     //-------------------------------------------------------------------------
-    /// r_advance succeeds when it can advance iterator by specified offset
+    /// r_rest matches the remainder of parsing range, O(1) unless the end is a sentinel
+    //-------------------------------------------------------------------------
+    struct r_rest final 
+    {
+        template<class Iterator, class Iterator2>
+        result<Iterator> operator() (Iterator i1, Iterator2 i2) const
+        {
+            static_assert(is_input_iterator<Iterator>);
+            return result(true, find_end(i1, i2));
+        }
+
+        const char* name() const { return "r_rest"; }
+    };
+
+    //-------------------------------------------------------------------------
+    /// r_advance succeeds when it can advance iterator by specified offset,
+    /// random access iterators are advanced in constant time
     //-------------------------------------------------------------------------
     template<class OffsetT>
     class r_advance final 
@@ -521,9 +782,11 @@ namespace axe
             static_assert(std::is_convertible_v<OffsetT,
                 typename std::iterator_traits<Iterator>::difference_type>);
 
-            typename std::iterator_traits<Iterator>::difference_type i = 0;
-            for (; i1 != i2 && i != offset_; ++i1, ++i);
-            return result(i == offset_, i1);
+            auto n = static_cast<typename std::iterator_traits<Iterator>::difference_type>(offset_);
+            if(n < 0 || !detail::advance_bounded(i1, i2, uint64_t(n)))
+                return result(false, find_end(i1, i2));
+
+            return result(true, i1);
         }
 
         const char* name() const { return "r_advance"; }
@@ -548,8 +811,8 @@ namespace axe
         explicit r_range(const Container& c) : begin(std::begin(c)), end(std::end(c)) {}
 
 
-        template<class I>
-        result<I> operator() (I i1, I i2) const
+        template<class I, class I2>
+        result<I> operator() (I i1, I2 i2) const
         {
             static_assert(is_input_iterator<I>);
             auto i = begin;
@@ -566,36 +829,4 @@ namespace axe
     template<class Container>
     explicit r_range(const Container&)->r_range<decltype(std::begin(std::declval<Container>()))>;
 
-    //-------------------------------------------------------------------------
-    /// r_regex creates rule from regular expression
-    //-------------------------------------------------------------------------
-    template<class CharT, class Traits = std::regex_traits<CharT>>
-    class r_regex final 
-    {
-        using Self = r_regex<CharT, Traits>;
-        std::basic_regex<CharT, Traits> rx; // regex to match
-    public:
-        template<class Arg, class... Args, class = detail::disable_copy<Arg, Self>>
-        explicit r_regex(Arg&& arg, Args&& ...args) : rx(std::forward<Arg>(arg), std::forward<Args>(args)...) {}
-
-        template<class I>
-        auto operator() (I i1, I i2) const
-        {
-            static_assert(is_bidirectional_iterator<I>);
-            std::match_results<I> mr;
-            auto matched = std::regex_search(i1, i2, mr, rx) && mr.prefix().length() == 0;
-            return make_result(matched, mr.suffix().first, i1);
-
-            return result(false, i1);
-        }
-
-        const char* name() const { return "r_regex"; }
-    };
-
-    template<class CharT>
-    explicit r_regex(const CharT*)->r_regex<CharT>;
-
-    template<class CharT, class ST, class SA>
-    explicit r_regex(const std::basic_string<CharT, ST, SA>&)->r_regex<CharT>;
-
 } // namespace
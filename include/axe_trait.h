@@ -33,6 +33,8 @@
 #include <tuple>
 #include <functional>
 #include <iterator>
+#include <string>
+#include <vector>
 #include "axe_macro.h"
 #include "axe_result.h"
 
@@ -60,6 +62,50 @@ namespace axe
     template<class I>
     constexpr auto is_random_access_iterator = std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<I>::iterator_category>;
 
+    namespace detail
+    {
+        template<class V>
+        constexpr bool is_char_type_v = std::is_same_v<V, char> || std::is_same_v<V, signed char> || std::is_same_v<V, unsigned char>
+            || std::is_same_v<V, wchar_t> || std::is_same_v<V, char16_t> || std::is_same_v<V, char32_t>;
+
+        template<class I, class V, bool = is_char_type_v<V>>
+        constexpr bool is_string_iterator_v = false;
+
+        template<class I, class V>
+        constexpr bool is_string_iterator_v<I, V, true> = std::is_same_v<I, typename std::basic_string<V>::iterator>
+            || std::is_same_v<I, typename std::basic_string<V>::const_iterator>;
+
+        template<class I, class V, bool = std::is_same_v<V, bool>>
+        constexpr bool is_vector_iterator_v = std::is_same_v<I, typename std::vector<V>::iterator>
+            || std::is_same_v<I, typename std::vector<V>::const_iterator>;
+
+        template<class I, class V>
+        constexpr bool is_vector_iterator_v<I, V, true> = false;
+
+        template<class I, class = void>
+        constexpr bool is_contiguous_iterator_v = false;
+
+        template<class I>
+        constexpr bool is_contiguous_iterator_v<I, std::enable_if_t<is_random_access_iterator<I>>> = std::is_pointer_v<I>
+            || is_string_iterator_v<I, typename std::iterator_traits<I>::value_type>
+            || is_vector_iterator_v<I, typename std::iterator_traits<I>::value_type>;
+    }
+
+    // contiguous iterators (pointers, std::string and std::vector iterators) allow block access to elements
+    template<class I>
+    constexpr auto is_contiguous_iterator = detail::is_contiguous_iterator_v<I>;
+
+    namespace detail
+    {
+        // rule doesn't depend on the iterator type (no semantic actions taking iterators),
+        // parse can run it over pointers of contiguous input, specialized next to the rules
+        template<class R, class = void>
+        struct iterator_independent_rule : std::false_type {};
+
+        template<class R>
+        constexpr bool is_iterator_independent_rule_v = iterator_independent_rule<std::remove_cv_t<std::remove_reference_t<R>>>::value;
+    }
+
     //-----------------------------
     // comparison traits
     //-----------------------------
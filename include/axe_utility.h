@@ -44,23 +44,126 @@
 #include "axe_iterator.h"
 #include "axe_composite.h"
 #include "axe_extractor.h"
+#include "axe_action.h"
+#include "axe_tape.h"
+#include "axe_context.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
 
 namespace axe
 {
     //-------------------------------------------------------------------------
-    // parse functions returning result<I>
+    // parse functions returning result<I>, end can be a sentinel (e.g. null_sentinel),
+    // iterator independent rules run over const pointers for all contiguous inputs
+    //-------------------------------------------------------------------------
+    template<class R, class I, class S, class = decltype(std::declval<I>() != std::declval<S>())>
+    auto parse(R&& r, I begin, S end)
+    {
+        if constexpr(detail::is_iterator_independent_rule_v<R> && detail::is_pointer_convertible_v<I, S>)
+            return detail::invoke_contiguous(r, begin, end);
+        else
+            return std::invoke(std::forward<R>(r), begin, end);
+    }
+
+    //-------------------------------------------------------------------------
+    // C string pointers are parsed up to the NUL terminator without calling strlen
     //-------------------------------------------------------------------------
     template<class R, class Txt>
     auto parse(R&& r, Txt&& txt)
     {
-        return std::invoke(std::forward<R>(r), std::begin(std::forward<Txt>(txt)), std::end(std::forward<Txt>(txt)));
+        if constexpr(std::is_pointer_v<std::remove_reference_t<Txt>>)
+            return std::invoke(std::forward<R>(r), txt, null_sentinel());
+        else
+            return parse(std::forward<R>(r), std::begin(std::forward<Txt>(txt)), std::end(std::forward<Txt>(txt)));
+    }
+
+    //-------------------------------------------------------------------------
+    // parse functions with parse context, slots of rules refer to ctx members
+    // the same rule can be used concurrently by threads passing different contexts
+    //-------------------------------------------------------------------------
+    template<class R, class Txt, class Ctx,
+        class = std::void_t<decltype(std::begin(std::declval<Txt>()))>,
+        class = std::enable_if_t<!std::is_same_v<std::decay_t<Txt>, std::decay_t<Ctx>>>>
+    auto parse(R&& r, Txt&& txt, Ctx& ctx)
+    {
+        detail::context_scope<Ctx> scope(ctx);
+        return parse(std::forward<R>(r), std::forward<Txt>(txt));
     }
 
     //-------------------------------------------------------------------------
-    template<class R, class I>
-    auto parse(R&& r, I begin, I end)
+    template<class R, class I, class Ctx>
+    auto parse(R&& r, I begin, I end, Ctx& ctx)
+    {
+        detail::context_scope<Ctx> scope(ctx);
+        return parse(std::forward<R>(r), begin, end);
+    }
+
+    namespace detail
+    {
+        template<class Input, class = void>
+        struct has_data : std::false_type {};
+
+        template<class Input>
+        struct has_data<Input, std::void_t<decltype(std::data(std::declval<const Input&>()))>>
+            : std::is_pointer<decltype(std::data(std::declval<const Input&>()))> {};
+
+        // hints the cache to load the beginning of contiguous input
+        template<class Input>
+        void prefetch_input(const Input& input)
+        {
+            if constexpr(std::is_pointer_v<Input> || has_data<Input>::value)
+            {
+                const void* p = nullptr;
+                if constexpr(std::is_pointer_v<Input>)
+                    p = input;
+                else
+                    p = std::data(input);
+#if defined(__GNUC__) || defined(__clang__)
+                __builtin_prefetch(p);
+#elif defined(_M_X64) || defined(_M_IX86)
+                _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#endif
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // parse_batch parses each input of the range and calls sink(input, result),
+    // inputs are ranges or null terminated strings (const char*),
+    // the next input is prefetched while the current one is parsed,
+    // returns the number of matched inputs
+    //-------------------------------------------------------------------------
+    template<class R, class Inputs, class Sink>
+    size_t parse_batch(R&& r, Inputs&& inputs, Sink&& sink)
+    {
+        static_assert(is_forward_iterator<decltype(std::begin(inputs))>);
+
+        size_t matched = 0;
+        auto end = std::end(inputs);
+        for(auto i = std::begin(inputs); i != end;)
+        {
+            auto& input = *i;
+            if(++i != end)
+                detail::prefetch_input(*i);
+
+            auto res = parse(r, input);
+            matched += res.matched;
+            std::invoke(sink, input, res);
+        }
+        return matched;
+    }
+
+    //-------------------------------------------------------------------------
+    // parse_batch with parse context, the context is set once for the whole batch
+    // and reused by all inputs, sink consumes and resets its members
+    //-------------------------------------------------------------------------
+    template<class R, class Inputs, class Ctx, class Sink>
+    size_t parse_batch(R&& r, Inputs&& inputs, Ctx& ctx, Sink&& sink)
     {
-        return std::invoke(std::forward<R>(r), begin, end);
+        detail::context_scope<Ctx> scope(ctx);
+        return parse_batch(std::forward<R>(r), std::forward<Inputs>(inputs), std::forward<Sink>(sink));
     }
 
     //-------------------------------------------------------------------------
@@ -80,6 +183,65 @@ namespace axe
         return detail::parse_tree_invoke(std::forward<R>(r), it_pair(begin, end));
     }
 
+    //-------------------------------------------------------------------------
+    // parse functions with deferred semantic actions, actions recorded by e_deferred
+    // are executed after successful parsing, otherwise discarded;
+    // only one log is active at a time: parse_deferred, parse_tape and push_parser
+    // can't be nested, and e_deferred must use the log passed to parse_deferred
+    //-------------------------------------------------------------------------
+    template<class R, class I>
+    auto parse_deferred(R&& r, action_log<I>& log, I begin, I end)
+    {
+        log.reset();
+        auto res = [&]
+        {
+            detail::action_scope scope(log);
+            return std::invoke(std::forward<R>(r), begin, end);
+        }();
+
+        if (res.matched)
+            log.commit();
+        else
+            log.reset();
+
+        return res;
+    }
+
+    //-------------------------------------------------------------------------
+    template<class R, class I, class Txt>
+    auto parse_deferred(R&& r, action_log<I>& log, Txt&& txt)
+    {
+        return parse_deferred(std::forward<R>(r), log, I(std::begin(txt)), I(std::end(txt)));
+    }
+
+    //-------------------------------------------------------------------------
+    // parse functions writing events to the tape, events of failed alternatives
+    // are removed from the tape, the tape is empty if parsing failed;
+    // the tape is the only active log, so the rule can't use e_deferred or nested parse_deferred
+    //-------------------------------------------------------------------------
+    template<class R, class I>
+    auto parse_tape(R&& r, event_tape<I>& tape, I begin, I end)
+    {
+        tape.reset(begin);
+        auto res = [&]
+        {
+            detail::action_scope scope(tape);
+            return std::invoke(std::forward<R>(r), begin, end);
+        }();
+
+        if (!res.matched)
+            tape.reset(begin);
+
+        return res;
+    }
+
+    //-------------------------------------------------------------------------
+    template<class R, class I, class Txt>
+    auto parse_tape(R&& r, event_tape<I>& tape, Txt&& txt)
+    {
+        return parse_tape(std::forward<R>(r), tape, I(std::begin(txt)), I(std::end(txt)));
+    }
+
     //-------------------------------------------------------------------------
     // writing parse-tree data in xml format
     //-------------------------------------------------------------------------
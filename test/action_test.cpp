@@ -0,0 +1,100 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include <string>
+#include <vector>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    GB_TEST(axe, test_deferred_actions)
+    {
+        using I = std::string::const_iterator;
+        const std::string text("key=value;");
+
+        action_log<I> log;
+        std::vector<std::string> fired;
+
+        auto action = [&](std::string tag)
+        {
+            return e_deferred(log, [&fired, tag](auto i1, auto i2)
+            {
+                fired.push_back(tag + ':' + std::string(i1, i2));
+            });
+        };
+
+        // the first alternative matches key and fails on ','
+        auto rule = (+_a >> action("assign") & '=' & +_a & ',')
+            | (+_a >> action("entry") & '=' & +_a >> action("value") & ';');
+
+        // not active log, actions are executed immediately
+        gbassert(parse(rule, text).matched);
+        gbassert(fired == std::vector<std::string>{ "assign:key", "entry:key", "value:value" });
+
+        // only actions on successful path are executed
+        fired.clear();
+        gbassert(parse_deferred(rule, log, text).matched);
+        gbassert(fired == std::vector<std::string>{ "entry:key", "value:value" });
+
+        // nothing is executed if parsing failed
+        fired.clear();
+        gbassert(!parse_deferred(rule & _z, log, std::string("key=value")).matched);
+        gbassert(fired.empty());
+        gbassert(log.pending() == 0);
+    }
+
+    GB_TEST(axe, test_deferred_many)
+    {
+        using I = std::string::const_iterator;
+        const std::string text("1,22,333,x");
+
+        action_log<I> log;
+        std::vector<std::string> numbers;
+        auto number = +_d >> e_deferred(log, [&](auto i1, auto i2) { numbers.emplace_back(i1, i2); });
+
+        // the last iteration matches ',' and fails on 'x', r_commit executes actions matched so far
+        size_t committed = 0;
+        auto rule = number % ',' & r_commit(log) >> [&] { committed = numbers.size(); } & ",x";
+
+        gbassert(parse_deferred(rule, log, text).matched);
+        gbassert(committed == 3);
+        gbassert(numbers == std::vector<std::string>{ "1", "22", "333" });
+
+        // optional and negation rules discard their actions
+        numbers.clear();
+        gbassert(parse_deferred(~(number & '!') & !(number & 'x') & number, log, text).matched);
+        gbassert(numbers == std::vector<std::string>{ "1" });
+    }
+}
@@ -0,0 +1,323 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <array>
+#include <vector>
+#include <deque>
+#include <list>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    GB_TEST(axe, test_binary_values)
+    {
+        const unsigned char data[] = { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0x01 };
+        std::vector<unsigned char> vec(std::begin(data), std::end(data));
+        std::list<unsigned char> list(std::begin(data), std::end(data));
+
+        // byte order conversion
+        uint32_t be = 0, le = 0;
+        uint16_t be16 = 0;
+        gbassert((r_var_be(be) & r_var_le(le) & r_var_be(be16))(vec.begin(), vec.end()).matched == false);
+        gbassert((r_var_be(be) & r_var_le(le))(vec.begin(), vec.end()).position == vec.begin() + 8);
+        gbassert(be == 0x12345678 && le == 0xf0debc9a);
+        be = le = 0;
+        gbassert((r_var_be(be) & r_var_le(le))(list.begin(), list.end()).matched);
+        gbassert(be == 0x12345678 && le == 0xf0debc9a);
+        gbassert(!r_var_be(be)(data + 6, std::end(data)).matched);
+
+        // arrays and sequences are the same for contiguous and node containers
+        std::array<uint16_t, 3> a1{}, a2{};
+        gbassert(r_array(a1)(data, std::end(data)).position == data + 6);
+        gbassert(r_array(a2)(list.begin(), list.end()).matched);
+        gbassert(a1 == a2);
+        std::array<uint32_t, 3> a3{};
+        gbassert(!r_array(a3)(vec.begin(), vec.end()).matched);
+
+        std::vector<uint16_t> s1, s2;
+        std::deque<uint16_t> s3;
+        auto seq1 = r_sequence(s1, 4, -1);
+        auto seq2 = r_sequence(s2, 0, -1);
+        auto seq3 = r_sequence(s3, 0, 3);
+        gbassert(seq1(vec.begin(), vec.end()).position == vec.begin() + 8); // incomplete element is not consumed
+        gbassert(seq2(list.begin(), list.end()).matched);
+        gbassert(seq3(data, std::end(data)).position == data + 6);
+        gbassert(s1.size() == 4 && std::vector<uint16_t>(s2.begin(), s2.end()) == s1);
+        gbassert(std::equal(s3.begin(), s3.end(), s1.begin()));
+        gbassert(!r_sequence(s1, 5, -1)(data, std::end(data)).matched);
+
+        std::string bytes;
+        gbassert(r_sequence(bytes, 0, 3)(data + 1, std::end(data)).position == data + 4);
+        gbassert(bytes == "\x34\x56\x78");
+    }
+
+    GB_TEST(axe, test_frame)
+    {
+        // message: u16 big endian length, type byte, nested frames with u8 length
+        const unsigned char data[] = { 0, 9, 'T', 3, 'a', 'b', 'c', 3, 'd', 'e', 'f', 0xff };
+        std::vector<std::string> fields;
+        unsigned char type = 0;
+        auto field = r_frame<uint8_t>(r_rest() >> [&](auto i1, auto i2) { fields.emplace_back(i1, i2); });
+        auto message = r_frame<uint16_t, byte_order::big>(r_var(type) & +field);
+        auto res = message(data, std::end(data));
+        gbassert(res.matched && res.position == data + 11);
+        gbassert(type == 'T' && fields == std::vector<std::string>({ "abc", "def" }));
+
+        // payload must be consumed entirely and fit in the input
+        gbassert(!r_frame<uint16_t, byte_order::big>(r_var(type) & field)(data, std::end(data)).matched);
+        gbassert(!r_frame<uint16_t, byte_order::big>()(data, data + 10).matched);
+        gbassert(r_frame<uint16_t, byte_order::big>()(data, data + 11).position == data + 11);
+
+        // payload view is not copied
+        const char* text = "\x05hello world";
+        std::string_view payload;
+        gbassert(r_frame<uint8_t>(r_rest() >> payload)(text, text + 12).position == text + 6);
+        gbassert(payload == "hello" && payload.data() == text + 1);
+        auto tree = parse_tree(r_frame<uint8_t>(), text, text + 12);
+        gbassert(tree.matched && tree.data.begin() == text + 1 && tree.data.end() == text + 6);
+
+        // leb128 length over forward iterators and sentinel
+        std::vector<unsigned char> big(300, 'x');
+        big.insert(big.begin(), { 0xac, 0x02 }); // 300
+        std::list<unsigned char> list(big.begin(), big.end());
+        gbassert(r_frame<leb128>()(big.begin(), big.end()).position == big.end());
+        gbassert(r_frame<leb128>(+r_lit('x'))(list.begin(), list.end()).position == list.end());
+        gbassert(!r_frame<leb128>()(big.begin(), big.end() - 1).matched);
+        gbassert(r_frame<leb128>()("\x03" "abc", null_sentinel()).matched);
+
+        const unsigned char overflow[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02 };
+        gbassert(!r_frame<leb128>()(overflow, std::end(overflow)).matched);
+    }
+
+    // reference varint encoder
+    void put_varint(std::vector<unsigned char>& out, uint64_t v)
+    {
+        for(; v >= 0x80; v >>= 7)
+            out.push_back(static_cast<unsigned char>(v | 0x80));
+        out.push_back(static_cast<unsigned char>(v));
+    }
+
+    uint64_t zigzag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+
+    GB_TEST(axe, test_varint)
+    {
+        // protobuf examples
+        const unsigned char data[] = { 0x96, 0x01, 0x03, 0xac, 0x02, 0x80 };
+        uint32_t u = 0;
+        uint8_t u8 = 0;
+        int32_t z = 0;
+        gbassert((r_varint(u) & r_zigzag(z))(data, std::end(data)).position == data + 3);
+        gbassert(u == 150 && z == -2);
+        gbassert(r_varint(u)(data + 3, std::end(data)).matched && u == 300);
+        gbassert(!r_varint(u8)(data + 3, std::end(data)).matched); // doesn't fit
+        auto truncated = r_varint(u)(data + 5, std::end(data));
+        gbassert(!truncated.matched && truncated.position == data + 5);
+
+        int32_t negative = 0;
+        std::vector<unsigned char> bytes;
+        put_varint(bytes, uint64_t(int64_t(-5))); // protobuf int32 encoding of negative numbers
+        gbassert(bytes.size() == 10 && r_varint(negative)(bytes.begin(), bytes.end()).matched && negative == -5);
+
+        // arrays of mixed length values, contiguous and node containers decode the same
+        std::vector<int64_t> values;
+        std::mt19937_64 gen(7);
+        bytes.clear();
+        for(int i = 0; i < 2000; ++i)
+        {
+            int64_t v = int64_t(gen() >> (gen() % 64)) * (i % 3 == 0 ? -1 : 1);
+            if(i % 5 < 3)
+                v = int64_t(gen() % 100) - 50; // runs of single byte values
+            values.push_back(v);
+            put_varint(bytes, zigzag(v));
+        }
+        bytes.push_back(0xff); // incomplete value is not consumed
+
+        std::vector<int64_t> v1;
+        std::deque<int64_t> v2;
+        gbassert(r_zigzag_array(v1)(bytes.begin(), bytes.end()).position == bytes.end() - 1);
+        std::list<unsigned char> list(bytes.begin(), bytes.end());
+        gbassert(r_zigzag_array(v2, 2000)(list.begin(), list.end()).matched);
+        gbassert(v1 == values && std::equal(v2.begin(), v2.end(), values.begin(), values.end()));
+        gbassert(!r_zigzag_array(v1, 2001)(bytes.data(), bytes.data() + bytes.size()).matched);
+
+        std::vector<uint16_t> small;
+        const unsigned char ones[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 0x80, 0x80, 0x04 };
+        gbassert(r_varint_array(small, 0, 9)(ones, std::end(ones)).position == ones + 9);
+        gbassert(small.size() == 9 && small.back() == 9);
+        gbassert(r_varint_array(small)(ones, std::end(ones)).position == ones + 10); // 65536 doesn't fit
+        gbassert(small.size() == 10 && small.back() == 10);
+
+        // values of every length, blocks of 8 bytes hold several values or a part of one
+        std::vector<uint64_t> lengths, decoded;
+        bytes.clear();
+        for(int i = 0; i < 1000; ++i)
+        {
+            auto v = gen() >> (gen() % 64);
+            lengths.push_back(v);
+            put_varint(bytes, v);
+        }
+        gbassert(r_varint_array(decoded)(bytes.begin(), bytes.end()).position == bytes.end() && decoded == lengths);
+
+        // value out of range in the middle of a block ends the run
+        const unsigned char block[] = { 1, 0x81, 0x01, 0x80, 0x80, 0x04, 2, 3, 4, 5, 6, 7 };
+        gbassert(r_varint_array(small)(block, std::end(block)).position == block + 3);
+        gbassert(small == (std::vector<uint16_t>{ 1, 129 }));
+    }
+
+    // writes n bits of value, the first written bit is the most significant for msb_first order
+    struct bit_writer
+    {
+        bit_order order;
+        std::vector<unsigned char> bytes;
+        unsigned bits = 0;
+
+        void put(uint64_t v, unsigned n)
+        {
+            for(unsigned k = 0; k < n; ++k, ++bits)
+            {
+                bool b = order == bit_order::msb_first ? (v >> (n - 1 - k)) & 1 : (v >> k) & 1;
+                if(bits % 8 == 0)
+                    bytes.push_back(0);
+                if(b)
+                    bytes.back() |= order == bit_order::msb_first ? 0x80 >> (bits % 8) : 1 << (bits % 8);
+            }
+        }
+    };
+
+    template<bit_order Order>
+    void test_bit_fields()
+    {
+        struct field { uint8_t a; uint16_t b; uint64_t c; uint8_t d; uint64_t e; };
+        std::vector<field> fields;
+        std::mt19937_64 gen(11);
+        bit_writer w{ Order, {} };
+        for(int i = 0; i < 500; ++i)
+        {
+            field f{ uint8_t(gen() & 1), uint16_t(gen() & 0x1fff), gen(), uint8_t(gen() & 0x7f), gen() >> 7 };
+            fields.push_back(f);
+            w.put(f.a, 1);
+            w.put(f.b, 13);
+            w.put(f.c, 64);
+            w.put(f.d, 7);
+            w.put(f.e, 57);
+        }
+
+        std::vector<field> v1, v2;
+        field f{};
+        auto record = [&](std::vector<field>& v)
+        {
+            return r_bits<1>(f.a) & r_bits<13>(f.b) & r_bits<64>(f.c) & r_bits<7>(f.d) & r_bits<57>(f.e)
+                >> [&] { v.push_back(f); };
+        };
+        auto equal = [](const field& x, const field& y) { return x.a == y.a && x.b == y.b && x.c == y.c && x.d == y.d && x.e == y.e; };
+
+        // contiguous input is read a word at a time, list a byte at a time
+        auto bits = bit_range<Order>(w.bytes);
+        gbassert(parse(*record(v1), bits.begin(), bits.end()).matched);
+        std::list<unsigned char> list(w.bytes.begin(), w.bytes.end());
+        auto list_bits = bit_range<Order>(list);
+        gbassert(parse(*record(v2), list_bits.begin(), list_bits.end()).matched);
+        gbassert(std::equal(v1.begin(), v1.end(), fields.begin(), fields.end(), equal));
+        gbassert(std::equal(v2.begin(), v2.end(), fields.begin(), fields.end(), equal));
+    }
+
+    GB_TEST(axe, test_bits)
+    {
+        const std::vector<unsigned char> data = { 0xb3, 0x5c }; // 1011 0011 0101 1100
+        auto msb = bit_range(data);
+        auto lsb = bit_range<bit_order::lsb_first>(data);
+
+        unsigned a = 0, b = 0, c = 0;
+        auto fields = r_bit_pattern<3>(0b101) & r_bits<5>(a) & r_bits<4>(b) & r_bits<4>(c);
+        gbassert(fields(msb.begin(), msb.end()).matched);
+        gbassert(a == 0b10011 && b == 0b0101 && c == 0b1100);
+        gbassert(!fields(lsb.begin(), lsb.end()).matched);
+
+        // deflate style lsb first fields
+        gbassert((r_bits<3>(a) & r_bits<5>(b) & r_bits<8>(c))(lsb.begin(), lsb.end()).matched);
+        gbassert(a == 0b011 && b == 0b10110 && c == 0x5c);
+
+        // bit fields compose with other rules, single bits are matched by r_lit
+        auto flag = r_bit_pattern<2>(0b11) | r_bit_pattern<2>(0b10);
+        auto r = (*flag & r_bits<9>(a))(msb.begin(), msb.end());
+        gbassert(r.matched && a == 0b001101011 && r.position.get() == data.begin() + 1 && r.position.bit() == 5);
+        gbassert((r_lit(true) & r_lit(false) & r_bits<6>(a))(msb.begin(), msb.end()).matched && a == 0b110011);
+
+        // fields don't extend past the end, which can be in the middle of byte
+        uint16_t u = 0;
+        gbassert(!r_bits<9>(u)(msb.begin(), bit_iterator(data.begin() + 1)).matched);
+        auto end = bit_iterator(data.begin() + 1, 4);
+        auto partial = (r_bits<8>(u) & r_bits<4>(b))(msb.begin(), end);
+        gbassert(partial.matched && partial.position == end && u == 0xb3 && b == 0b0101);
+        gbassert(!(r_bits<8>(u) & r_bits<5>(b))(msb.begin(), end).matched);
+
+        test_bit_fields<bit_order::msb_first>();
+        test_bit_fields<bit_order::lsb_first>();
+    }
+
+    GB_TEST(axe, test_advance)
+    {
+        std::vector<unsigned char> blob(1 << 20, 'x');
+        blob.back() = 'y';
+        gbassert(r_advance(blob.size())(blob.data(), blob.data() + blob.size()).matched);
+        auto r = r_advance(blob.size() + 1)(blob.begin(), blob.end());
+        gbassert(!r.matched && r.position == blob.end());
+        gbassert(!r_advance(-1)(blob.begin(), blob.end()).matched);
+        gbassert(r_advance(0)(blob.end(), blob.end()).matched);
+
+        std::list<unsigned char> list(blob.begin(), blob.begin() + 100);
+        gbassert(r_advance(100)(list.begin(), list.end()).position == list.end());
+        auto rl = r_advance(101)(list.begin(), list.end());
+        gbassert(!rl.matched && rl.position == list.end());
+
+        // payload skipped in input_buffer is read in one block and can be backtracked
+        input_buffer<std::vector<unsigned char>::const_iterator> buf(blob.cbegin(), blob.cend());
+        auto skip = (r_advance(blob.size() - 1) & 'z') | (r_advance(blob.size() - 1) & 'y');
+        gbassert(skip(buf.begin(), buf.end()).position == buf.end());
+        gbassert(!r_advance(blob.size() + 1)(buf.begin(), buf.end()).matched);
+
+        std::istringstream ss("header:payload;");
+        input_buffer<std::istreambuf_iterator<char>> stream(std::istreambuf_iterator<char>(ss), {});
+        auto b = stream.begin();
+        auto rs = (r_advance(6) & ':' & r_advance(7) & ';')(b, stream.end());
+        gbassert(rs.matched && rs.position == stream.end());
+        gbassert(!r_advance(3)(b, std::next(b, 2)).matched); // not past the end of range
+    }
+}
\ No newline at end of file
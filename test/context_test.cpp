@@ -0,0 +1,174 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <array>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    struct record
+    {
+        std::string name;
+        int id = 0;
+        double value = 0;
+        unsigned hex = 0;
+        int total = 0;
+    };
+
+    GB_TEST(axe, test_context)
+    {
+        const auto id = slot(&record::id);
+
+        // grammar is built once and shared by all threads
+        const auto grammar = _ident >> slot(&record::name)
+            & ',' & r_decimal(id)
+            & ',' & r_double(slot(&record::value))
+            & ',' & r_hex(slot(&record::hex))
+            & ',' & r_expression(slot(&record::total))
+            & _z;
+
+        std::vector<std::thread> threads;
+        std::array<bool, 4> passed{};
+
+        for(size_t t = 0; t < passed.size(); ++t)
+        {
+            threads.emplace_back([&grammar, &passed, t]
+            {
+                passed[t] = true;
+                for(int n = 0; n < 500; ++n)
+                {
+                    record rec;
+                    auto text = "name" + std::to_string(t) + ',' + std::to_string(n) + ",-" + std::to_string(n)
+                        + ".5,ff," + std::to_string(n) + "*2+" + std::to_string(t);
+                    passed[t] = passed[t] && parse(grammar, text, rec).matched
+                        && rec.name == "name" + std::to_string(t) && rec.id == n
+                        && rec.value == -n - 0.5 && rec.hex == 255 && rec.total == n * 2 + int(t);
+                }
+            });
+        }
+
+        for(auto& thread : threads)
+            thread.join();
+
+        gbassert(passed == (std::array<bool, 4>{ true, true, true, true }));
+    }
+
+    struct packet
+    {
+        unsigned short length = 0;
+        std::vector<unsigned char> payload;
+        std::array<char, 2> tag{};
+    };
+
+    GB_TEST(axe, test_context_binary)
+    {
+        const auto rule = r_var(slot(&packet::length))
+            & r_array(slot(&packet::tag))
+            & r_sequence(slot(&packet::payload), 0, 3);
+
+        const unsigned char data[] = { 3, 0, 'a', 'b', 1, 2, 3 };
+        packet p1, p2;
+        gbassert(parse(rule, data, p1).matched);
+        gbassert(parse(rule, data, p2).matched);
+        gbassert(parse(rule, std::begin(data), std::end(data), p2).matched);
+
+        gbassert(p1.length == 3 && p1.tag[0] == 'a' && p1.tag[1] == 'b');
+        gbassert(p1.payload == std::vector<unsigned char>{ 1, 2, 3 });
+        // sequence bound to slot is cleared before matching
+        gbassert(p2.payload == p1.payload);
+
+        // slot bound rule parsed without context
+        bool thrown = false;
+        try
+        {
+            parse(rule, data);
+        }
+        catch(const failure<char>& f)
+        {
+            thrown = f.what() == std::string("parse context is not set");
+        }
+        gbassert(thrown);
+    }
+
+    GB_TEST(axe, test_parse_batch)
+    {
+        struct kv
+        {
+            std::string key;
+            int value = 0;
+        };
+
+        const auto rule = _ident >> slot(&kv::key) & '=' & r_decimal(slot(&kv::value)) & _z;
+        const std::vector<std::string> lines{ "a=1", "bb=-22", "c==3", "ddd=4" };
+
+        kv ctx;
+        std::vector<std::string> keys;
+        int sum = 0;
+        auto matched = parse_batch(rule, lines, ctx, [&](const std::string& line, auto res)
+        {
+            if(res.matched)
+            {
+                keys.push_back(ctx.key);
+                sum += ctx.value;
+            }
+            else
+                keys.push_back("error: " + line);
+        });
+
+        gbassert(matched == 3);
+        gbassert(keys == std::vector<std::string>{ "a", "bb", "error: c==3", "ddd" });
+        gbassert(sum == 1 - 22 + 4);
+
+        // without context
+        gbassert(parse_batch(+_d & _z, lines, [](auto&, auto) {}) == 0);
+
+        // null terminated messages
+        const char* messages[] = { "e=5", "f=x", "gg=60" };
+        keys.clear();
+        sum = 0;
+        gbassert(parse_batch(rule, messages, ctx, [&](const char*, auto res)
+        {
+            if(res.matched)
+            {
+                keys.push_back(ctx.key);
+                sum += ctx.value;
+            }
+        }) == 2);
+        gbassert(keys == std::vector<std::string>{ "e", "gg" } && sum == 65);
+    }
+}
@@ -0,0 +1,175 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <list>
+#include <random>
+#include <atomic>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    using records = std::vector<std::vector<std::string>>;
+
+    template<class I>
+    records split_records(I begin, I end, csv_format fmt = csv_format())
+    {
+        records recs(1);
+        auto field = [&](auto i1, auto i2) { recs.back().push_back(csv_unquote(i1, i2, fmt.quote)); };
+        auto record = [&](auto, auto) { recs.emplace_back(); };
+        gbassert(r_csv(field, record, fmt)(begin, end).matched);
+        recs.pop_back();
+        return recs;
+    }
+
+    // random records with quoted delimiters, quotes and line ends
+    std::string random_csv(unsigned seed, size_t count)
+    {
+        std::mt19937 gen(seed);
+        const char* fields[] = { "", "a", "1234", "\"x,y\"", "\"line\nbreak\"", "\"say \"\"hi\"\"\"", "\"\"", "long field value" };
+        std::string text;
+        for(size_t i = 0; i < count; ++i)
+        {
+            for(unsigned k = 0, n = gen() % 6 + 1; k < n; ++k)
+                text.append(k ? "," : "").append(fields[gen() % std::size(fields)]);
+            text += gen() % 3 ? "\n" : "\r\n";
+        }
+        return text;
+    }
+
+    GB_TEST(axe, test_csv_record)
+    {
+        std::string text = "Year,Make,Model\r\n2010,Ford,\"E350, \"\"Wagon\"\"\"\n\n"
+            "2011,Toyota,\"Tundra\nCREWMAX\"";
+        auto recs = split_records(text.begin(), text.end());
+        gbassert((recs == records{ { "Year", "Make", "Model" }, { "2010", "Ford", "E350, \"Wagon\"" }, { "" },
+            { "2011", "Toyota", "Tundra\nCREWMAX" } }));
+
+        // the same fields from node container and record by record
+        std::list<char> list(text.begin(), text.end());
+        gbassert(split_records(list.begin(), list.end()) == recs);
+
+        std::vector<std::string> fields;
+        size_t count = 0;
+        auto record = r_csv_record([&](auto i1, auto i2) { fields.emplace_back(i1, i2); }) >> [&] { ++count; };
+        gbassert(parse(+record & r_end(), text).matched);
+        gbassert(count == 4 && fields.size() == 10 && fields[5] == "E350, \"\"Wagon\"\"");
+        gbassert(parse(r_csv_record(), text).position == text.begin() + 17);
+
+        // tab separated values, commas are not delimiters
+        std::string tsv = "a,b\t'c\td'\t\n";
+        gbassert((split_records(tsv.begin(), tsv.end(), csv_format{ '\t', '\'' }) == records{ { "a,b", "c\td", "" } }));
+        gbassert((split_records(tsv.begin(), tsv.end(), tsv_format) == records{ { "a,b", "'c", "d'", "" } }));
+
+        // input can't end inside quotes
+        std::string open = "a,b\nc,\"d\ne";
+        gbassert(!r_csv(detail::csv_ignore(), detail::csv_ignore())(open.begin(), open.end()).matched);
+        std::list<char> open_list(open.begin(), open.end());
+        gbassert(!r_csv(detail::csv_ignore(), detail::csv_ignore())(open_list.begin(), open_list.end()).matched);
+        gbassert(!parse(r_csv_record(), std::string("\"abc")).matched);
+
+        // extractors run only for matched records
+        size_t calls = 0;
+        auto count_calls = [&](auto, auto) { ++calls; };
+        std::string partial = "a,\"b";
+        std::list<char> partial_list(partial.begin(), partial.end());
+        gbassert(!parse(r_csv_record(count_calls), partial).matched);
+        gbassert(!r_csv_record(count_calls)(partial_list.begin(), partial_list.end()).matched);
+        gbassert(!r_csv(count_calls, count_calls)(open.begin(), open.end()).matched);
+        gbassert(!r_csv(count_calls, count_calls)(open_list.begin(), open_list.end()).matched);
+        gbassert(calls == 0);
+        gbassert(!parse(r_csv_record(count_calls) & r_csv_record(count_calls), open).matched);
+        gbassert(calls == 2);
+
+        // wide records
+        std::string wide;
+        for(int i = 0; i < 40; ++i)
+            wide += std::to_string(i) + (i < 39 ? "," : "\r\n");
+        fields.clear();
+        gbassert(parse(+record, wide + wide).matched);
+        gbassert(fields.size() == 80 && fields[39] == "39" && fields[79] == "39");
+    }
+
+    GB_TEST(axe, test_csv_blocks)
+    {
+        // quoted regions crossing 64 byte blocks, contiguous and node containers agree
+        for(unsigned seed = 0; seed < 20; ++seed)
+        {
+            auto text = random_csv(seed, 200);
+            std::list<char> list(text.begin(), text.end());
+            auto recs = split_records(text.data(), text.data() + text.size());
+            gbassert(recs.size() == 200);
+            gbassert(split_records(list.begin(), list.end()) == recs);
+        }
+    }
+
+    GB_TEST(axe, test_csv_parallel)
+    {
+        auto text = random_csv(7, 5000);
+        auto recs = split_records(text.begin(), text.end());
+
+        for(size_t parts : { 1, 2, 3, 8, 1000 })
+        {
+            auto chunks = csv_split(text, parts);
+            gbassert(!chunks.empty() && chunks.size() <= parts);
+            std::string joined;
+            records all;
+            for(auto chunk : chunks)
+            {
+                joined.append(chunk);
+                auto part = split_records(chunk.begin(), chunk.end());
+                all.insert(all.end(), part.begin(), part.end());
+            }
+            gbassert(joined == text && all == recs);
+        }
+
+        std::vector<records> results(4);
+        std::atomic<size_t> calls{ 0 };
+        gbassert(parse_csv_parallel(text, [&](size_t k, std::string_view chunk)
+        {
+            ++calls;
+            results[k] = split_records(chunk.begin(), chunk.end());
+            return true;
+        }, 4));
+
+        records all;
+        for(size_t k = 0; k < calls; ++k)
+            all.insert(all.end(), results[k].begin(), results[k].end());
+        gbassert(all == recs);
+        gbassert(!parse_csv_parallel(text, [](size_t k, std::string_view) { return k != 1; }, 4));
+        gbassert(csv_split("", 4).size() == 1 && csv_split("a\nb", 4).size() == 1);
+    }
+}
@@ -43,4 +43,52 @@ namespace
         std::string exp{ R"**(1+ 3/2* (4.0/5.0+ 3.14) )**" };
         gbassert(axe::parse_expression(exp, 0.0) == 6.91);
     }
-}
\ No newline at end of file
+
+    GB_TEST(axe, test_skip_cached)
+    {
+        using namespace axe;
+        using namespace axe::shortcuts;
+
+        // heavy whitespace and backtracking alternatives
+        std::string exp{ "  ( 1 +   2 )  *  ( 3   -  1 ) /  4  +  ( 5  )  " };
+        gbassert(parse_expression(exp, 0.0) == 6.5);
+
+        // cached and uncached skipping produce the same matches
+        auto item = ("ab"_axe & ';') | ('a' & +_d) | ('a' & 'b');
+        auto list = +item & _z;
+        auto comment = '#' & *(_ - '\n') & '\n';
+        for(std::string text : { std::string("  a b ; a  1 2  a b"), std::string(" a\tb;a 12   a"), std::string("   ") })
+        {
+            auto r1 = r_skip(list, " \t")(text.begin(), text.end());
+            auto r2 = r_skip_cached(list, +r_any(" \t"))(text.begin(), text.end());
+            gbassert(r1.matched == r2.matched && r1.position == r2.position);
+        }
+
+        std::string text(" a #comment\n b ; # x\n a 1 #\n ");
+        auto skipper = +r_any(" \t\n") | comment;
+        auto r1 = r_skip(list, skipper)(text.begin(), text.end());
+        auto r2 = r_skip_cached(list, skipper)(text.begin(), text.end());
+        gbassert(r1.matched && r2.matched && r1.position == r2.position);
+
+        // expression grammar re-skipping whitespace and comments before each tried operator
+        std::string expr("  ( 12.5 +   2 )  *  ( 3   -  1 ) /  4  # note\n +  ( 5  *  ( 7 - 6 ) )  -   0.25 ");
+        auto expr_skipper = +_s | comment;
+        double v1 = 0, v2 = 0;
+        auto e1 = r_skip(r_expression(v1) & _z, expr_skipper)(expr.begin(), expr.end());
+        auto e2 = r_skip_cached(r_expression(v2) & _z, expr_skipper)(expr.begin(), expr.end());
+        gbassert(e1.matched && e2.matched && e1.position == e2.position && v1 == v2 && v1 == 12);
+
+        // cached skipping nested in repetition, each match pays only for the positions it visits
+        std::string items;
+        for(int i = 0; i < 100000; ++i)
+            items += "x ";
+        auto u = *r_skip(r_lit('x'), +r_lit(' '));
+        auto c = *r_skip_cached(r_lit('x'), +r_lit(' '));
+        auto u1 = u(items.begin(), items.end());
+        auto c1 = c(items.begin(), items.end());
+        gbassert(u1.matched && c1.matched && u1.position == c1.position && c1.position == items.end());
+
+        // the iterator holds only a cache reference and a position
+        static_assert(sizeof(cached_skip_iterator<const char*, decltype(+r_lit(' '))>) == 2 * sizeof(void*));
+    }
+}
@@ -0,0 +1,99 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+
+#include <string>
+#include <vector>
+#include <list>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    GB_TEST(axe, test_istr)
+    {
+        static_assert(is_contiguous_iterator<const char*>);
+        static_assert(is_contiguous_iterator<std::string::const_iterator>);
+        static_assert(is_contiguous_iterator<std::vector<int>::iterator>);
+        static_assert(!is_contiguous_iterator<std::list<char>::iterator>);
+
+        // sql statement
+        std::string table, column;
+        auto name = _ident;
+        auto select = "select"_iaxe & +_ws & (name >> column) & +_ws & "FROM"_iaxe & +_ws & (name >> table) & *_ws & _z;
+        gbassert(parse(select, std::string("SeLeCt id fRoM users")).matched);
+        gbassert(column == "id" && table == "users");
+        gbassert(!parse(select, std::string("selekt id from users")).matched);
+
+        // http header with long literal crossing 8 byte blocks
+        std::string value;
+        auto header = "content-transfer-encoding:"_iaxe & *_hs & (+(_ - _endl) >> value) & _endl;
+        gbassert(parse(header, std::string("Content-Transfer-Encoding: gzip")).matched);
+        gbassert(value == "gzip");
+
+        // mismatch position is the first different element, including inside the blocks
+        std::string literal("abcdefghijklmnop-qrstuvw");
+        for(size_t length = 0; length <= literal.size(); ++length)
+        {
+            auto r = r_istr(literal.substr(0, length));
+            for(size_t pos = 0; pos < length; ++pos)
+            {
+                std::string text = literal.substr(0, length);
+                for(size_t i = 0; i < text.size(); i += 2)
+                    text[i] = char(std::toupper(text[i]));
+                gbassert(r(text.begin(), text.end()).matched);
+                gbassert(r(text.begin(), text.begin() + pos).position == text.begin() + pos);
+                text[pos] = '@';
+                auto res = r(text.begin(), text.end());
+                gbassert(!res.matched && res.position == text.begin() + pos);
+
+                std::list<char> list(text.begin(), text.end());
+                gbassert(!r(list.begin(), list.end()).matched);
+            }
+        }
+
+        // non-letters are matched exactly
+        gbassert(!parse("a-b"_iaxe, std::string("a\rb")).matched);
+        gbassert(!parse("[a]"_iaxe, std::string("{A}")).matched);
+        gbassert(parse(L"key"_iaxe, std::wstring(L"KEY")).matched);
+        gbassert(!parse(r_istr("a"), std::wstring(L"\x161")).matched);
+
+        // case insensitive literals compile to dfa
+        std::vector<token> tokens;
+        lexer lex("select"_iaxe, +_ws);
+        lex.skip(1);
+        gbassert(lex.tokenize(std::string("SELECT Select select"), tokens).matched);
+        gbassert(tokens.size() == 3);
+    }
+}
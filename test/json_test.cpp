@@ -0,0 +1,271 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    // byte by byte structural index
+    std::vector<uint32_t> naive_index(std::string_view text)
+    {
+        std::vector<uint32_t> positions;
+        bool in_string = false;
+        for(size_t i = 0; i < text.size(); ++i)
+        {
+            char c = text[i];
+            if(c == '\\' && ++i < text.size())
+                c = text[i] == '"' ? 0 : text[i]; // only quotes are escaped, outside of strings too
+            if(c == '"')
+            {
+                positions.push_back(uint32_t(i));
+                in_string = !in_string;
+            }
+            else if(!in_string && (c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ','))
+                positions.push_back(uint32_t(i));
+        }
+        return positions;
+    }
+
+    const char* vehicles = R"*({
+"category": 1,
+"sub-category": 1.1,
+"name": "inventory",
+"tags": ["warehouse","inventory"],
+"vehicles" :
+[
+        {
+        "id": 123456789,
+        "make": "Honda",
+        "model": "Ridgeline",
+        "trim": "RTL",
+        "price": 32616,
+        "tags": ["truck","V6","4WD"]
+        },
+        {
+        "id": 748201836,
+        "make": "Honda",
+        "model": "Pilot",
+        "trim": "Touring",
+        "price": 38042,
+        "tags": ["SUV","V6","4WD"]
+        }
+]
+})*";
+
+    GB_TEST(axe, test_json_index)
+    {
+        // strings with escaped quotes and runs of backslashes crossing 64 byte blocks
+        std::mt19937 gen(3);
+        const char* pieces[] = { "{", "}", "[", "]", ":", ",", " ", "a", "\\", "\\\\", "\\\"", "\"", "{\"k\\\\\":[1,\"]\"]}" };
+        for(int n = 0; n < 200; ++n)
+        {
+            std::string text;
+            while(text.size() < 300)
+                text += pieces[gen() % std::size(pieces)];
+
+            json_index idx(text);
+            std::vector<uint32_t> positions;
+            for(auto p = idx.next(idx.begin()); p != idx.end(); p = idx.next(p + 1))
+                positions.push_back(uint32_t(p - idx.begin()));
+            gbassert(positions == naive_index(text));
+        }
+
+        json_index idx(vehicles);
+        auto end = vehicles + std::strlen(vehicles);
+        gbassert(idx.indexed(vehicles) && !idx.indexed(vehicles + 1) && idx.next(vehicles + 1) == vehicles + 2);
+        gbassert(idx.next(end - 1) == end - 1 && idx.next(end) == end);
+
+        // strings without escapes and control characters are not rescanned
+        std::string escapes = std::string(100, ' ') + "\"a\\tb\" \"\n\"\n\"" + std::string(70, 'c') + "\"";
+        json_index escapes_idx(escapes);
+        auto text = escapes_idx.begin();
+        gbassert(escapes_idx.plain(text, text + 101) && escapes_idx.plain(text + 103, text + 105));
+        gbassert(!escapes_idx.plain(text + 101, text + 105) && !escapes_idx.plain(text + 108, text + 109));
+        gbassert(escapes_idx.plain(text + 110, text + 111) && escapes_idx.plain(text + 112, text + 182));
+    }
+
+    GB_TEST(axe, test_json_value)
+    {
+        std::string_view text(vehicles);
+        json_index idx(text);
+        gbassert(parse(json_value(idx) & r_end(), text).matched);
+        gbassert(parse(json_object(idx) & r_end(), text).matched);
+        gbassert(!parse(json_array(idx), text).matched);
+
+        auto valid = [](std::string_view json)
+        {
+            json_index idx(json);
+            return parse(json_value(idx) & r_end(), json).matched;
+        };
+
+        gbassert(valid("[]") && valid("{}") && valid("[ 1 , -2.5e+3, true, false, null, \"\\u00e9\\n\" ]"));
+        gbassert(valid("{\"a\":{\"b\":[[],{}]},\"c\":0}") && valid("\"\\\\\"") && valid("-0.0"));
+        gbassert(!valid("[1,]") && !valid("[1 2]") && !valid("{\"a\" 1}") && !valid("{\"a\":1,}") && !valid("{1:2}"));
+        gbassert(!valid("[01]") && !valid("[1.]") && !valid("[.5]") && !valid("[1e]") && !valid("[tru]"));
+        gbassert(!valid("[\"\\x\"]") && !valid("[\"\\u12g4\"]") && !valid("[\"a\tb\"]") && !valid("\"abc"));
+        gbassert(!valid("[}") && !valid("{]") && !valid("[[]") && !valid("[1]]"));
+        gbassert(!valid(std::string(2000, '[') + std::string(2000, ']')));
+
+        // values inside other rules
+        std::string str;
+        double d = 0;
+        std::string_view tagged("tag=\"value\";n=-12.5");
+        json_index tagged_idx(tagged);
+        gbassert(parse("tag=" & json_string(tagged_idx) >> str & ";n=" & json_number(tagged_idx) >> d, tagged).matched);
+        gbassert(str == "\"value\"" && d == -12.5);
+
+        // text other than indexed doesn't match
+        std::string copy(text);
+        gbassert(!parse(json_value(idx), copy).matched);
+        gbassert(!parse(json_member(idx, "name", json_value(idx)), copy).matched);
+        gbassert(!parse(json_array(idx, json_value(idx)), std::string_view("[1]")).matched);
+    }
+
+    GB_TEST(axe, test_json_member)
+    {
+        std::string_view text(vehicles);
+        json_index idx(text);
+
+        // on demand extraction of nested values
+        std::string name;
+        std::vector<std::string> tags, makes;
+        std::vector<double> prices;
+        auto tag = json_string(idx) >> [&](auto i1, auto i2) { tags.emplace_back(i1 + 1, i2 - 1); };
+        // members of the same object are matched in one pass
+        auto vehicle = json_members(idx, { "price", "make" },
+            r_double() >> [&](auto i1, auto i2) { prices.push_back(std::stod(std::string(i1, i2))); },
+            json_string(idx) >> [&](auto i1, auto i2) { makes.push_back(json_unescape(i1, i2)); });
+        auto inventory = json_members(idx, { "name", "tags", "vehicles" },
+            json_string(idx) >> name, json_array(idx, tag), json_array(idx, vehicle));
+
+        gbassert(parse(inventory & r_end(), text).matched);
+        gbassert(name == "\"inventory\"");
+        gbassert((tags == std::vector<std::string>{ "warehouse", "inventory" }));
+        gbassert((makes == std::vector<std::string>{ "Honda", "Honda" }));
+        gbassert((prices == std::vector<double>{ 32616, 38042 }));
+
+        gbassert(!parse(json_member(idx, "missing", json_value(idx)), text).matched);
+        gbassert(!parse(json_member(idx, "category", json_string(idx)), text).matched);
+        gbassert(parse(json_member(idx, "sub-category", r_double()), text).matched);
+
+        // skipped containers must close with matching bracket
+        auto skipped = [](std::string_view json)
+        {
+            json_index idx(json);
+            return parse(json_member(idx, "b", r_decimal()) & r_end(), json).matched;
+        };
+        gbassert(skipped("{\"a\": [1, {}], \"b\": 2}") && skipped("{\"a\": \"[\", \"b\": 2}"));
+        gbassert(!skipped("{\"a\": [1}, \"b\": 2}") && !skipped("{\"a\": {\"x\": [1]], \"b\": 2}") && !skipped("{\"a\": [[1], \"b\": 2}"));
+
+        // rules are matched in listed order on the first members with the keys
+        std::string_view repeated("{\"b\": 2, \"a\": 1, \"b\": 3}");
+        json_index repeated_idx(repeated);
+        std::vector<int> order;
+        auto number = [&](auto i1, auto) { order.push_back(*i1 - '0'); };
+        gbassert(parse(json_members(repeated_idx, { "a", "b" }, r_decimal() >> number, r_decimal() >> number) & r_end(), repeated).matched);
+        gbassert((order == std::vector<int>{ 1, 2 }));
+        gbassert(!parse(json_members(repeated_idx, { "a", "c" }, r_decimal(), r_decimal()), repeated).matched);
+        gbassert(!parse(json_members(repeated_idx, { "a", "b" }, r_decimal(), json_string(repeated_idx)), repeated).matched);
+
+        std::string_view empty("{ } [ ]");
+        json_index empty_idx(empty);
+        size_t count = 0;
+        gbassert(!parse(json_member(empty_idx, "a", json_value(empty_idx)), empty).matched);
+        gbassert(parse(json_object(empty_idx) & _ws & json_array(empty_idx, json_value(empty_idx) >> [&] { ++count; }), empty).matched);
+        gbassert(count == 0);
+    }
+
+    GB_TEST(axe, test_json_unescape)
+    {
+        auto unescape = [](std::string_view json)
+        {
+            json_index idx(json);
+            std::string str;
+            auto matched = parse(json_string(idx) >> [&](auto i1, auto i2) { str = json_unescape(i1, i2); } & r_end(), json).matched;
+            return matched ? str : "<failed>";
+        };
+
+        gbassert(unescape("\"\"").empty() && unescape("\"plain\"") == "plain");
+        gbassert(unescape("\"a\\\"b\\\\c\\/d\"") == "a\"b\\c/d");
+        gbassert(unescape("\"\\b\\f\\n\\r\\t\"") == "\b\f\n\r\t");
+        gbassert(unescape("\"\\u0041\\u00e9\\u20AC\"") == "A\xc3\xa9\xe2\x82\xac");
+        gbassert(unescape("\"\\ud83d\\ude00\"") == "\xf0\x9f\x98\x80");
+        gbassert(unescape("\"\\ud83dx\\ude00\"") == "\xef\xbf\xbdx\xef\xbf\xbd");
+        gbassert(unescape("\"\\ud83d\\u0041\"") == "\xef\xbf\xbd" "A");
+
+        std::string_view raw("a\\tb");
+        gbassert(json_unescape(raw.begin(), raw.end()) == "a\tb");
+    }
+
+    GB_TEST(axe, test_ndjson)
+    {
+        std::string stream;
+        for(int i = 0; i < 100; ++i)
+            stream += "{\"id\": " + std::to_string(i) + ", \"tags\": [\"x\\n\", {\"}\": \"]\"}]}\r\n" + (i % 10 == 0 ? "\n  \n" : "");
+
+        json_index idx;
+        int id = 0, sum = 0;
+        std::vector<std::string> records;
+        auto record = json_member(idx, "id", r_decimal(id) >> [&] { sum += id; });
+        auto parser = make_ndjson_parser(idx, record, [&](auto itp) { records.emplace_back(itp.begin(), itp.end()); });
+
+        // chunks split lines at arbitrary places
+        for(size_t i = 0; i < stream.size(); i += 37)
+            gbassert(parser.push(std::string_view(stream).substr(i, 37)));
+        gbassert(parser.buffered() == 0);
+        gbassert(parser.push("{\"id\": 1000}"));
+        gbassert(parser.buffered() == 12);
+        gbassert(parser.finish());
+        gbassert(records.size() == 101 && sum == 4950 + 1000 && records.back() == "{\"id\": 1000}");
+        gbassert(parser.consumed() == stream.size() + 12);
+
+        auto failing = make_ndjson_parser(idx, json_value(idx), [](auto) {});
+        gbassert(failing.push("[1]\n{\"a\":1} [2]\n[3]\n") == false);
+        gbassert(failing.failed() && failing.consumed() == 4);
+        gbassert(!failing.push("[4]\n") && !failing.finish());
+
+        // a long line arriving in small chunks is searched for line end once
+        std::string long_line = "[\"" + std::string(1 << 20, 'x') + "\"]\n";
+        size_t lines = 0;
+        auto long_parser = make_ndjson_parser(idx, json_array(idx), [&](auto) { ++lines; });
+        for(size_t i = 0; i < long_line.size(); i += 16)
+            gbassert(long_parser.push(std::string_view(long_line).substr(i, 16)));
+        gbassert(lines == 1 && long_parser.buffered() == 0 && long_parser.finish());
+    }
+}
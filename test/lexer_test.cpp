@@ -0,0 +1,157 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include <string>
+#include <vector>
+#include <list>
+#include <random>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    enum kind { kw_let, ident, number, string, assign, plus, semicolon, space };
+
+    GB_TEST(axe, test_lexer)
+    {
+        lexer lex(
+            r_str("let"),
+            _ident,
+            +_d & ~('.' & +_d),
+            '"' & *(_ - '"') & '"',
+            r_char('='),
+            r_char('+'),
+            r_char(';'),
+            +_ws);
+        lex.skip(space);
+
+        const std::string text("let x = 1.5 + letter;\nlet s = \"a b\";");
+        std::vector<token> tokens;
+        gbassert(lex.tokenize(text, tokens).matched);
+
+        std::vector<int> kinds(tokens.begin(), tokens.end());
+        gbassert(kinds == std::vector<int>{ kw_let, ident, assign, number, plus, ident, semicolon,
+            kw_let, ident, assign, string, semicolon });
+        gbassert(get_as<std::string>(make_it_pair(tokens[3], text.begin())) == "1.5");
+        gbassert(get_as<std::string>(make_it_pair(tokens[5], text.begin())) == "letter");
+
+        // token level grammar, generic extractors need explicit return type
+        // because extractor detection is done with character iterators
+        std::vector<std::string> names;
+        auto value = r_char(ident) | r_char(number) | r_char(string);
+        auto statement = r_char(kw_let)
+            & r_char(ident) >> [&](auto i1, auto) -> void { names.push_back(get_as<std::string>(make_it_pair(*i1, text.begin()))); }
+            & r_char(assign) & value % r_pred([](int k) { return k == plus; }) & r_char(semicolon);
+
+        gbassert(parse(+statement & _z, tokens).matched);
+        gbassert(names == std::vector<std::string>{ "x", "s" });
+
+        // lexing stops at characters not matched by any token rule
+        tokens.clear();
+        auto res = lex.tokenize(std::string("let x = 1 ? 2;"), tokens);
+        gbassert(!res.matched && tokens.size() == 4);
+    }
+
+    GB_TEST(axe, test_dfa)
+    {
+        // repetitions with separators and ranges
+        auto dfa = detail::make_dfa(r_many(_d, ',', 2, 3), r_numstr(1, 2) & r_any("xy"), "ab"_axe);
+        using match_t = std::pair<int, std::ptrdiff_t>;
+        auto match = [&](const std::string& s)
+        {
+            auto [kind, i] = dfa.longest_match(s.begin(), s.end());
+            return match_t(kind, i - s.begin());
+        };
+
+        gbassert(match("1,2,3,4") == match_t(0, 5));
+        gbassert(match("1,x") == match_t(-1, 0));
+        gbassert(match("12y") == match_t(1, 3));
+        gbassert(match("123y") == match_t(-1, 0));
+        gbassert(match("abc") == match_t(2, 2));
+    }
+
+    GB_TEST(axe, test_r_dfa)
+    {
+        auto tel = ('(' & _d * 3 & ')' & _d * 3 & '-' & _d * 4)
+            | (_d * 3 & '-' & _d * 3 & '-' & _d * 4)
+            | ("1-" & _d * 3 & '-' & _d * 3 & '-' & _d * 4)
+            | (_d * 3 & '.' & _d * 3 & '.' & _d * 4);
+        auto tel_dfa = r_dfa(tel);
+
+        // the same matches as combinators for unambiguous token shapes
+        std::mt19937 gen(38);
+        for(size_t i = 0; i < 2000; ++i)
+        {
+            std::string text;
+            auto length = std::uniform_int_distribution<size_t>(0, 16)(gen);
+            for(size_t k = 0; k < length; ++k)
+                text += "0123456789()-.1"[std::uniform_int_distribution<size_t>(0, 14)(gen)];
+
+            auto expected = tel(text.cbegin(), text.cend());
+            auto actual = tel_dfa(text.cbegin(), text.cend());
+            gbassert(actual.matched == expected.matched && (!actual.matched || actual.position == expected.position));
+        }
+
+        std::vector<std::string> tels;
+        const std::string text("call (650)329-2100 or 1-408-278-7400, fax 650.617.3120");
+        gbassert(parse(*(*(_ - tel_dfa) & tel_dfa >> e_push_back(tels)), text).matched);
+        gbassert(tels == std::vector<std::string>{ "(650)329-2100", "1-408-278-7400", "650.617.3120" });
+
+        // forward iterators
+        std::list<char> list{ 'a', 'b', 'a', 'b', '!' };
+        auto ab = r_dfa(+("ab"_axe | 'a'));
+        gbassert(ab(list.begin(), list.end()).position == std::prev(list.end()));
+        std::string digits("123x");
+        gbassert(r_dfa(*_d & 'x')(digits.cbegin(), digits.cend()).position == digits.cend());
+
+        // rules where the longest match differs from ordered choice and greedy repetition are rejected
+        auto rejected = [](const auto& r)
+        {
+            try { r_dfa{ r }; }
+            catch(const failure<char>&) { return true; }
+            return false;
+        };
+        gbassert(rejected('a' | "ab"_axe) && rejected(+('a' | "ab"_axe)) && rejected(~_d | _d * 2));
+        gbassert(rejected(*_d & _d) && rejected(~_d & _d) && rejected(~("ab"_axe | 'a') & 'b'));
+        gbassert(rejected(r_many(_d, ~_d)) && rejected(*(_d & ~_a) & _a));
+        gbassert(!rejected("ab"_axe | 'a') && !rejected(*_d & 'x') && !rejected(r_many(+_d, ',') & ';'));
+        gbassert(!rejected(_d * 3 & '.' & _d * 3) && !rejected(~('-' & +_d) & ~('.' & +_d)));
+
+        gbassert(first_set(tel_dfa) == first_set(tel) && !is_nullable(tel_dfa) && is_nullable(r_dfa(*_d)));
+
+        // extractors and recursive rules are not regular
+        static_assert(!detail::is_regular_rule_v<decltype(_d >> e_ref(digits))>);
+        static_assert(!detail::is_regular_rule_v<r_rule<std::string::iterator>>);
+    }
+}
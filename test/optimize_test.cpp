@@ -0,0 +1,199 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+
+#include <string>
+#include <vector>
+#include <random>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    // random strings over a small alphabet containing all interesting characters
+    std::vector<std::string> random_inputs(size_t count)
+    {
+        const std::string alphabet = "ab\"\\,\n 09";
+        std::mt19937 gen(2022);
+        std::uniform_int_distribution<size_t> length(0, 12), letter(0, alphabet.size() - 1);
+
+        std::vector<std::string> inputs;
+        for(size_t i = 0; i < count; ++i)
+        {
+            std::string s;
+            for(size_t n = length(gen); n; --n)
+                s.push_back(alphabet[letter(gen)]);
+            inputs.push_back(std::move(s));
+        }
+        return inputs;
+    }
+
+    // char iterator counting reads of each position
+    class counting_iterator
+    {
+        const char* p_ = nullptr;
+        const char* base_ = nullptr;
+        std::vector<size_t>* reads_ = nullptr;
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = char;
+        using pointer = const char*;
+        using reference = const char&;
+
+        counting_iterator() = default;
+        counting_iterator(const char* p, const char* base, std::vector<size_t>* reads) : p_(p), base_(base), reads_(reads) {}
+
+        reference operator* () const { ++(*reads_)[p_ - base_]; return *p_; }
+        counting_iterator& operator++ () { ++p_; return *this; }
+        counting_iterator operator++ (int) { auto tmp = *this; ++p_; return tmp; }
+        bool operator== (const counting_iterator& other) const { return p_ == other.p_; }
+        bool operator!= (const counting_iterator& other) const { return p_ != other.p_; }
+    };
+
+    // optimized rule must match the same inputs to the same position
+    template<class R>
+    void check_equivalence(const R& r, const std::vector<std::string>& inputs)
+    {
+        auto o = optimize(r);
+        for(auto& s : inputs)
+        {
+            auto r1 = r(s.data(), s.data() + s.size());
+            auto r2 = o(s.data(), s.data() + s.size());
+            gbassert(r1.matched == r2.matched);
+            gbassert(!r1.matched || r1.position == r2.position);
+        }
+    }
+
+    GB_TEST(axe, test_optimize)
+    {
+        const auto inputs = random_inputs(2000);
+        auto ab = r_str("ab");
+
+        auto json_char = (_ - '"' - '\\') | ('\\' & r_any("\"\\"));
+        auto csv_value = +(_ - ',' - _endl);
+        auto search = *(_ - ab) & ab;
+        auto search_lit = *(_ - "a\""_axe) & "a\""_axe;
+        auto bounded = r_many(_ - ab, 2, 4) & ab;
+        auto limited = r_many(_d | ',', 0, 3) & _z;
+
+        // class rules are folded to bitmaps, repetitions to r_predstr
+        static_assert(std::is_same_v<decltype(optimize(_ - '"' - '\\')), r_pred<detail::is_byte_class_t<decltype(_ - '"' - '\\')>>>);
+        static_assert(std::is_same_v<decltype(optimize(+_d)), r_predstr<is_num, true>>);
+        static_assert(std::is_same_v<decltype(optimize(search)), detail::r_scan_t<r_str<char>, r_str<char>>>);
+        static_assert(std::is_same_v<decltype(optimize(csv_value)), detail::r_span_t<detail::optimized_t<decltype(_endl)>, r_char<char>>>);
+
+        check_equivalence(json_char, inputs);
+        check_equivalence(*json_char & '"', inputs);
+        check_equivalence(csv_value, inputs);
+        check_equivalence(csv_value % ',' & _endl, inputs);
+        check_equivalence(*(_ - ',' - _endl) & _z, inputs);
+        check_equivalence(r_many(_ - ab - _endl, 2, 4), inputs);
+        check_equivalence(r_many(_ - _endl, 0, 0), inputs);
+        check_equivalence((!_endl) & _, inputs);
+        check_equivalence(search, inputs);
+        check_equivalence(search_lit, inputs);
+        check_equivalence(*(_ - ab) & r_str("a\""), inputs);
+        check_equivalence(*(_ - (ab | ',')) & (ab | ','), inputs);
+        check_equivalence(*(_ - (ab | ',')) & (ab | '\n'), inputs);
+        check_equivalence(*(_ - r_many(_d, 2, 3)) & r_many(_d, 2, 3), inputs);
+        check_equivalence(*(search & ','), inputs);
+        check_equivalence(bounded, inputs);
+        check_equivalence(limited, inputs);
+        check_equivalence(r_many(_a, 0, 0), inputs);
+        check_equivalence((!ab) & _, inputs);
+        check_equivalence(r_find(ab & ','), inputs);
+        check_equivalence(r_find(_z), inputs);
+        check_equivalence(~r_named(+_d, "digits") & *(_ - _endl) & _endl, inputs);
+
+        // searched rule is evaluated once at the match position
+        std::string text("xaxab,");
+        auto count_reads = [&](const auto& r)
+        {
+            std::vector<size_t> reads(text.size());
+            auto res = r(counting_iterator(text.data(), text.data(), &reads),
+                counting_iterator(text.data() + text.size(), text.data(), &reads));
+            gbassert(res.matched);
+            return reads[4]; // the last character of the match
+        };
+        gbassert(count_reads(search) == 2 && count_reads(optimize(search)) == 1);
+        gbassert(count_reads(optimize(*(_ - r_str("ab")) & r_str("ab"))) == 1);
+        gbassert(count_reads(optimize(*(_ - (ab | ',')) & (ab | ','))) == 1);
+
+        // extractors keep working and are not skipped
+        std::vector<std::string> values;
+        auto extract = (+(_ - ',') >> e_push_back(values)) % ',';
+        std::string csv("a,bb,\"x\"");
+        gbassert(optimize(extract)(csv.begin(), csv.end()).matched);
+        gbassert(values == std::vector<std::string>{ "a", "bb", "\"x\"" });
+    }
+
+    GB_TEST(axe, test_many_single_element)
+    {
+        const auto inputs = random_inputs(2000);
+
+        static_assert(detail::is_single_element_rule_v<decltype(_)>);
+        static_assert(detail::is_single_element_rule_v<decltype(_ - 'a' - _d)>);
+        static_assert(detail::is_single_element_rule_v<decltype(r_char('a') | _d)>);
+        static_assert(!detail::is_single_element_rule_v<decltype(_ - "ab"_axe)>);
+
+        // counted scan must agree with the generic loop over opaque rule
+        auto check = [&](auto&& r, size_t min_occurrence, size_t max_occurrence)
+        {
+            auto fast = r_many(r, min_occurrence, max_occurrence);
+            auto generic = r_many(r_rule<const char*>(r), min_occurrence, max_occurrence);
+            for(auto& s : inputs)
+            {
+                auto r1 = fast(s.data(), s.data() + s.size());
+                auto r2 = generic(s.data(), s.data() + s.size());
+                gbassert(r1.matched == r2.matched);
+                gbassert(!r1.matched || r1.position == r2.position);
+            }
+        };
+
+        for(auto [min_occurrence, max_occurrence] : { std::pair<size_t, size_t>{ 0, -1 }, { 1, -1 }, { 2, 5 }, { 0, 0 }, { 3, 3 } })
+        {
+            check(_, min_occurrence, max_occurrence);
+            check(_d, min_occurrence, max_occurrence);
+            check(r_char('a'), min_occurrence, max_occurrence);
+            check(_ - ',' - '\n', min_occurrence, max_occurrence);
+            check(r_char('a') | r_char('b') | _ws, min_occurrence, max_occurrence);
+        }
+
+        std::string text("   xyz");
+        gbassert((*_ws)(text.begin(), text.end()).position == text.begin() + 3);
+        gbassert((_ * 4)(text.begin(), text.end()).position == text.begin() + 4);
+        gbassert(!(_ * 7)(text.begin(), text.end()).matched);
+    }
+}
@@ -0,0 +1,182 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include <string>
+#include <vector>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    GB_TEST(axe, test_push_parser)
+    {
+        const std::string stream("a=1;bb=22;ccc=333;dddd=4444;");
+
+        // feed the stream in chunks of different size
+        for(size_t chunk = 1; chunk <= stream.size(); ++chunk)
+        {
+            action_log<push_iterator<>> log;
+            std::vector<std::string> records, values;
+
+            auto record = _ident & '=' & (+_d >> e_deferred(log, [&](auto i1, auto i2) { values.emplace_back(i1, i2); })) & ';';
+            auto parser = make_push_parser(record, [&](auto itp) { records.emplace_back(itp.begin(), itp.end()); }, log);
+
+            for(size_t i = 0; i < stream.size(); i += chunk)
+                gbassert(parser.push(std::string_view(stream).substr(i, chunk)));
+
+            gbassert(parser.finish());
+            gbassert(records == std::vector<std::string>{ "a=1;", "bb=22;", "ccc=333;", "dddd=4444;" });
+            gbassert(values == std::vector<std::string>{ "1", "22", "333", "4444" });
+            gbassert(parser.buffered() == 0 && parser.consumed() == stream.size());
+        }
+    }
+
+    GB_TEST(axe, test_push_parser_incomplete)
+    {
+        std::vector<std::string> numbers;
+        auto parser = make_push_parser(+_d & ~_s, [&](auto itp) { numbers.emplace_back(itp.begin(), itp.end()); });
+
+        // greedy rule reaching the end of data waits for more
+        gbassert(parser.push("12 34"));
+        gbassert(numbers == std::vector<std::string>{ "12 " } && parser.buffered() == 2);
+        gbassert(parser.push("5 6"));
+        gbassert(numbers == std::vector<std::string>{ "12 ", "345 " } && parser.buffered() == 1);
+
+        // the end of stream completes the last record
+        gbassert(parser.finish());
+        gbassert(numbers.back() == "6");
+
+        // errors are reported as soon as the record can't match
+        auto failing = make_push_parser(+_d & ';', [](auto) {});
+        gbassert(failing.push("1;2"));
+        gbassert(!failing.push("x;"));
+        gbassert(failing.failed() && failing.consumed() == 2);
+    }
+
+    GB_TEST(axe, test_push_parser_large_record)
+    {
+        // large record arriving in small chunks is matched a logarithmic number of times
+        const std::string digits(1 << 20, '7');
+        size_t attempts = 0;
+        std::vector<size_t> records;
+        auto record = (r_empty() >> [&](auto, auto) { ++attempts; }) & +_d & ';';
+        auto parser = make_push_parser(record, [&](auto itp) { records.push_back(itp.end() - itp.begin()); });
+
+        for(size_t i = 0; i < digits.size(); i += 16)
+            gbassert(parser.push(std::string_view(digits).substr(i, 16)));
+        gbassert(parser.push(";1;"));
+        gbassert(parser.finish());
+        gbassert(records == (std::vector<size_t>{ digits.size() + 1, 2 }));
+        gbassert(attempts < 64);
+    }
+
+    GB_TEST(axe, test_push_parser_flush)
+    {
+        // record completed by a small chunk is passed to sink by flush
+        std::vector<std::string> lines;
+        auto line = *(_ - '\n') & '\n';
+        auto parser = make_push_parser(line, [&](auto itp) { lines.emplace_back(itp.begin(), itp.end()); });
+
+        gbassert(parser.push("HELLO WORLD"));
+        gbassert(lines.empty() && parser.buffered() == 11);
+        gbassert(parser.push("\n") && parser.flush());
+        gbassert(lines == std::vector<std::string>{ "HELLO WORLD\n" } && parser.buffered() == 0);
+        gbassert(parser.push("A\n"));
+        gbassert(lines.size() == 2 && lines.back() == "A\n");
+        gbassert(parser.push("B") && parser.flush() && parser.push("\n") && parser.flush());
+        gbassert(lines.size() == 3 && lines.back() == "B\n");
+    }
+
+    GB_TEST(axe, test_push_parser_length)
+    {
+        // rules checking the available length must wait for the rest of a record
+        const std::string stream("V\x02\x00" "R+++" "F\x03" "abc" "V\x05\x00" "F\x00" "R---", 21);
+        for(size_t chunk = 1; chunk <= stream.size(); ++chunk)
+        {
+            uint16_t v = 0;
+            std::vector<std::string> records;
+            auto record = ('V' & r_var_le(v)) | ('R' & r_advance(3)) | ('F' & r_frame<uint8_t>());
+            auto parser = make_push_parser(record, [&](auto itp) { records.emplace_back(itp.begin(), itp.end()); });
+
+            for(size_t i = 0; i < stream.size(); i += chunk)
+                gbassert(parser.push(std::string_view(stream).substr(i, chunk)));
+
+            gbassert(parser.finish());
+            gbassert(records == std::vector<std::string>{ std::string("V\x02\x00", 3), "R+++", "F\x03" "abc",
+                std::string("V\x05\x00", 3), std::string("F\x00", 2), "R---" });
+            gbassert(v == 5);
+        }
+    }
+
+    GB_TEST(axe, test_push_parser_advance)
+    {
+        // r_advance waits for the rest of a record split across chunks
+        std::vector<std::string> records;
+        auto parser = make_push_parser('R' & r_advance(3), [&](auto itp) { records.emplace_back(itp.begin(), itp.end()); });
+        gbassert(parser.push("Rab"));
+        gbassert(records.empty() && parser.buffered() == 3);
+        gbassert(parser.push("cRabc"));
+        gbassert(parser.finish());
+        gbassert(records == std::vector<std::string>{ "Rabc", "Rabc" });
+
+        // too short at the end of stream
+        auto truncated = make_push_parser('R' & r_advance(3), [](auto) {});
+        gbassert(truncated.push("Rabc" "Ra"));
+        gbassert(!truncated.finish() && truncated.consumed() == 4);
+    }
+
+    GB_TEST(axe, test_push_parser_frame)
+    {
+        // partly arrived frame waits for the rest of its payload
+        std::vector<std::string> frames;
+        auto parser = make_push_parser(r_frame<uint8_t>(), [&](auto itp) { frames.emplace_back(itp.begin(), itp.end()); });
+        gbassert(parser.push("\x03" "a"));
+        gbassert(frames.empty() && parser.buffered() == 2);
+        gbassert(parser.push("bc" "\x02" "d"));
+        gbassert(frames == std::vector<std::string>{ "\x03" "abc" });
+        gbassert(parser.push("e"));
+        gbassert(parser.finish());
+        gbassert(frames == std::vector<std::string>{ "\x03" "abc", "\x02" "de" });
+
+        // length prefix split across chunks, the extractor may run again on the complete frame
+        std::vector<std::string> payloads;
+        std::string payload(200, 'x');
+        auto leb = make_push_parser(r_frame<leb128>(r_rest() >> [&](auto i1, auto i2) { payloads.emplace_back(i1, i2); }), [](auto) {});
+        gbassert(leb.push("\xc8"));
+        gbassert(leb.push("\x01" + payload.substr(0, 100)));
+        gbassert(leb.push(payload.substr(100)));
+        gbassert(leb.finish());
+        gbassert(!payloads.empty() && payloads.back() == payload);
+    }
+}
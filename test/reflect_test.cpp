@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include <string>
+#include <vector>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    GB_TEST(axe, test_reflect)
+    {
+        r_rule<const char*> opaque;
+        auto number = +_d;
+        auto sign = ~(r_char('+') | r_char('-'));
+        auto value = sign & number;
+        auto list = value % ',' & _z;
+        auto keyword = "if"_axe | "else"_axe;
+
+        static_assert(rule_kind_v<decltype(_d)> == rule_kind::predicate);
+        static_assert(rule_kind_v<decltype(number)> == rule_kind::repeat);
+        static_assert(rule_kind_v<decltype(sign)> == rule_kind::optional);
+        static_assert(rule_kind_v<decltype(value)> == rule_kind::sequence);
+        static_assert(rule_kind_v<decltype(keyword)> == rule_kind::choice);
+        static_assert(rule_kind_v<decltype(!_d)> == rule_kind::lookahead);
+        static_assert(rule_kind_v<decltype(_z)> == rule_kind::terminal);
+        static_assert(rule_kind_v<decltype(std::ref(value))> == rule_kind::reference);
+        static_assert(rule_kind_v<decltype(opaque)> == rule_kind::other);
+
+        // nullable
+        gbassert(!is_nullable(number));
+        gbassert(is_nullable(sign));
+        gbassert(!is_nullable(value));
+        gbassert(is_nullable(*_d));
+        gbassert(is_nullable(_z));
+        gbassert(is_nullable(opaque)); // opaque rules are conservative
+
+        // first set skips nullable prefix
+        auto first = first_set(value);
+        gbassert(first.count() == 12);
+        gbassert(first.test('+') && first.test('-') && first.test('0') && first.test('9'));
+        gbassert(!first.test('a'));
+        auto kw = first_set(keyword);
+        gbassert(kw.count() == 2 && kw.test('i') && kw.test('e'));
+        gbassert(first_set(r_str("")).none());
+        gbassert(first_set(opaque).all());
+
+        // fixed length
+        gbassert(fixed_length(r_str("abc")) == size_t(3));
+        gbassert(fixed_length(_d & ':' & "ab"_axe) == size_t(4));
+        gbassert(fixed_length("ab"_axe | "cd"_axe) == size_t(2));
+        gbassert(!fixed_length("ab"_axe | "c"_axe));
+        gbassert(fixed_length(r_many(_d, ',', 3, 3)) == size_t(5));
+        gbassert(!fixed_length(number));
+        gbassert(fixed_length(r_bin(0u)) == sizeof(unsigned));
+        gbassert(fixed_length((!_d) & _a) == size_t(1));
+
+        // extractors and named rules are transparent
+        int n = 0;
+        auto extracted = number >> n;
+        static_assert(rule_kind_v<decltype(extracted)> == rule_kind::extractor);
+        gbassert(first_set(extracted) == first_set(number));
+        gbassert(!is_nullable(r_named(value, "value")));
+
+        // walk visits all descendants
+        size_t nodes = 0, depth = 0;
+        walk(list, [&](const auto&, size_t d) { ++nodes; depth = std::max(depth, d); });
+        gbassert(nodes > 5 && depth >= 3);
+
+        std::vector<rule_kind> kinds;
+        visit_children(value, [&](const auto& child) { kinds.push_back(kind_of(child)); });
+        gbassert(kinds == std::vector<rule_kind>{ rule_kind::optional, rule_kind::repeat });
+        gbassert(std::string(to_string(rule_kind::choice)) == "choice");
+    }
+}
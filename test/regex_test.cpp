@@ -0,0 +1,158 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+
+
+#include <string>
+#include <list>
+#include <regex>
+#include <random>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    // random pattern over small alphabet exercising all supported constructs
+    std::string random_pattern(std::mt19937& gen, size_t depth)
+    {
+        static const char* atoms[] = { "a", "b", "c", ".", "[ab]", "[^a]", "[a-b]", "\\w", "\\d", "\\.", "(?:ab)", "[\\da]" };
+        static const char* quantifiers[] = { "", "", "*", "+", "?", "*?", "+?", "??", "{2}", "{1,2}", "{0,2}?", "{1,}" };
+        static const char* group_quantifiers[] = { "", "?", "??" }; // groups may match empty string, not repeated
+        auto pick = [&](size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(gen); };
+
+        std::string pattern;
+        auto length = 1 + pick(3);
+        for(size_t i = 0; i < length; ++i)
+        {
+            if(depth > 0 && pick(4) == 0)
+                pattern += "(" + random_pattern(gen, depth - 1) + (pick(2) ? "|" + random_pattern(gen, depth - 1) : "") + ")"
+                    + group_quantifiers[pick(std::size(group_quantifiers))];
+            else
+                pattern += std::string(atoms[pick(std::size(atoms))]) + quantifiers[pick(std::size(quantifiers))];
+        }
+        return pattern;
+    }
+
+    // group with bounded repeat over a body with internal choices, the body can't match empty string
+    std::string random_bounded_group(std::mt19937& gen)
+    {
+        static const char* atoms[] = { "a", "b", ".", "[ab]", "[^a]", "b[ab]{1,2}", ".+?.?", "a*b", "(?:ab|a)" };
+        static const char* quantifiers[] = { "{0,2}?", "{1,2}?", "{1,3}?", "{2,3}?", "{0,2}", "{1,3}" };
+        auto pick = [&](size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(gen); };
+        auto body = [&] { return std::string(atoms[pick(std::size(atoms))]) + (pick(2) ? atoms[pick(std::size(atoms))] : ""); };
+
+        return "(?:" + body() + (pick(2) ? "|" + body() : "") + ")" + quantifiers[pick(std::size(quantifiers))]
+            + (pick(2) ? "a" : random_pattern(gen, 0));
+    }
+
+    bool std_match(const std::regex& rx, const std::string& text, size_t& length)
+    {
+        std::smatch mr;
+        auto matched = std::regex_search(text, mr, rx, std::regex_constants::match_continuous);
+        length = matched ? mr.length(0) : 0;
+        return matched;
+    }
+
+    GB_TEST(axe, test_regex)
+    {
+        // anchored at the current position, no scanning for the match
+        auto number = r_regex("[+-]?\\d+(?:\\.\\d*)?");
+        gbassert(number.compiled());
+        std::string text("-12.5e");
+        auto res = number(text.cbegin(), text.cend());
+        gbassert(res.matched && res.position == text.cbegin() + 5);
+        text = "x12";
+        gbassert(!number(text.cbegin(), text.cend()).matched);
+
+        // leftmost first alternatives and lazy quantifiers
+        text = "abcabc";
+        gbassert(r_regex("a|ab")(text.cbegin(), text.cend()).position == text.cbegin() + 1);
+        gbassert(r_regex("(?:abc)+?")(text.cbegin(), text.cend()).position == text.cbegin() + 3);
+        gbassert(r_regex(".*c")(text.cbegin(), text.cend()).position == text.cend());
+        gbassert(r_regex(".*?c")(text.cbegin(), text.cend()).position == text.cbegin() + 3);
+
+
+        // forward iterators
+        std::list<char> list{ 'a', 'a', 'b', '!' };
+        auto rl = r_regex("a+b")(list.cbegin(), list.cend());
+        gbassert(rl.matched && rl.position == std::prev(list.cend()));
+        auto fallback = r_regex("(a)\\1b")(list.cbegin(), list.cend());
+        gbassert(fallback.matched && fallback.position == std::prev(list.cend()));
+
+        // unsupported features use std::regex
+        gbassert(!r_regex("(a)\\1").compiled());
+        gbassert(!r_regex("a\\b").compiled());
+        gbassert(!r_regex("(?:a?b?)+").compiled());
+        gbassert(!r_regex("abc", std::regex::icase).compiled());
+        text = "ABCd";
+        gbassert(r_regex("abc", std::regex::icase)(text.cbegin(), text.cend()).position == text.cbegin() + 3);
+
+        // repeated regex in r_many consumes input in linear time
+        std::string words;
+        for(size_t i = 0; i < 2000; ++i)
+            words += "word ";
+        auto many = +r_regex("\\w+\\s");
+        gbassert(parse(many, words).matched);
+
+        // lazy bounded repeats try all shorter matches before the next copy
+        text = "bbabaa";
+        gbassert(r_regex("(?:b[ab]{1,2}){0,2}?a")(text.cbegin(), text.cend()).position == text.cend());
+        text = "bacaacb";
+        gbassert(r_regex("(?:.+?.?){0,2}?a")(text.cbegin(), text.cend()).position == text.cbegin() + 5);
+
+        // compiled automata agree with std::regex
+        std::mt19937 gen(2023);
+        for(size_t i = 0; i < 1000; ++i)
+        {
+            auto pattern = i % 2 ? random_pattern(gen, 2) : random_bounded_group(gen);
+            std::regex rx(pattern);
+            r_regex<char> r(pattern);
+            gbassert(r.compiled());
+
+            for(size_t j = 0; j < 20; ++j)
+            {
+                std::string input;
+                auto length = std::uniform_int_distribution<size_t>(0, 8)(gen);
+                for(size_t k = 0; k < length; ++k)
+                    input += "abc1."[std::uniform_int_distribution<size_t>(0, 4)(gen)];
+
+                size_t expected_length = 0;
+                auto expected = std_match(rx, input, expected_length);
+                auto actual = r(input.cbegin(), input.cend());
+                gbassert(actual.matched == expected);
+                gbassert(!expected || actual.position == input.cbegin() + expected_length);
+            }
+        }
+    }
+}
@@ -30,6 +30,10 @@
 #include <map>
 #include <vector>
 #include <tuple>
+#include <string>
+#include <sstream>
+#include <regex>
+#include <iterator>
 #include <yadro/util/gbtest.h>
 #pragma warning(disable:4503)
 #include "../include/axe.h"
@@ -88,4 +92,73 @@ namespace
         gbassert(std::get<1>(replacement) == 2);
         gbassert(std::get<0>(replacement) == golden);
     }
+
+    GB_TEST(axe, test_replace)
+    {
+        using namespace axe;
+        using namespace axe::shortcuts;
+
+        std::string text("call 650-329-2100 or 408-278-7400");
+        std::string out;
+        auto res = replace(_d * 3 & '-' & _d * 3 & '-' & _d * 4, text, "<tel>", std::back_inserter(out));
+        gbassert(res.count == 2 && out == "call <tel> or <tel>");
+
+        // callback returning replacement and callback removing matches
+        out.clear();
+        replace(+_d, text, [](auto i1, auto i2) { return "[" + std::string(i1, i2) + "]"; }, std::back_inserter(out));
+        gbassert(out == "call [650]-[329]-[2100] or [408]-[278]-[7400]");
+
+        out.clear();
+        size_t digits = 0;
+        replace(_d, text, [&](auto, auto) { ++digits; }, std::back_inserter(out));
+        gbassert(digits == 20 && out == "call -- or --");
+
+        // multiple literals
+        out.clear();
+        text = "cats and dogs";
+        gbassert(replace(r_find_any({ "cat", "dog" }), text, "pet", std::back_inserter(out)).count == 2);
+        gbassert(out == "pets and pets");
+
+        // the same as std::regex_replace, including empty matches
+        for(auto pattern : { "\\d+", "\\d*", "a|bc", "b?" })
+        {
+            for(auto input : { "", "a1bc22", "bbcab1", "xyz" })
+            {
+                out.clear();
+                replace(r_regex(pattern), std::string(input), "#", std::back_inserter(out));
+                gbassert(out == std::regex_replace(input, std::regex(pattern), "#"));
+            }
+        }
+
+        // input iterators are read through released buffer
+        std::string source;
+        for(size_t i = 0; i < 10000; ++i)
+            source += "abracadabra " + std::to_string(i) + " ";
+        std::istringstream is(source);
+        std::ostringstream os;
+        auto stream_res = replace(r_str("abracadabra"), std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>(),
+            "magic", std::ostreambuf_iterator<char>(os));
+        out.clear();
+        replace(r_str("abracadabra"), source, "magic", std::back_inserter(out));
+        gbassert(stream_res.count == 10000 && os.str() == out && std::get<0>(replace(source, "abracadabra", "magic")) == out);
+
+        // buffer reads input only when it's needed
+        std::istringstream lazy("abc");
+        input_buffer<std::istreambuf_iterator<char>> buf(std::istreambuf_iterator<char>(lazy), {});
+        auto b = buf.begin();
+        gbassert(lazy.tellg() == 0);
+        gbassert(b != buf.end() && *b == 'a');
+
+        // releasing already released position keeps the buffer
+        auto c = std::next(b, 2);
+        buf.release(c);
+        buf.release(b);
+        gbassert(*c == 'c' && ++c == buf.end());
+
+        std::istringstream empty;
+        os.str("");
+        stream_res = replace(r_str("a"), std::istreambuf_iterator<char>(empty), std::istreambuf_iterator<char>(),
+            "b", std::ostreambuf_iterator<char>(os));
+        gbassert(stream_res.count == 0 && os.str().empty());
+    }
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+
+
+#include <string>
+#include <vector>
+#include <list>
+#include <random>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    // ordered choice of patterns tried at each position, the same as r_find(lit1 | lit2 | ...)
+    std::pair<size_t, size_t> naive_find(const std::vector<std::string>& patterns, const std::string& text)
+    {
+        for(size_t pos = 0; pos <= text.size(); ++pos)
+            for(size_t p = 0; p < patterns.size(); ++p)
+                if(text.compare(pos, patterns[p].size(), patterns[p]) == 0)
+                    return { p, pos };
+        return { size_t(-1), 0 };
+    }
+
+    GB_TEST(axe, test_find_any)
+    {
+        auto words = r_find_any({ "he", "she", "his", "hers" });
+        std::string text("ushers");
+        auto res = words.search(text.cbegin(), text.cend());
+        gbassert(res.matched && res.data.first == 1 && res.position == text.cbegin() + 4);
+        gbassert(res.data.second.begin() == text.cbegin() + 1);
+        gbassert(!words(text.cbegin(), text.cbegin() + 2).matched);
+
+        // the same as r_find with alternatives
+        auto alternatives = r_find("he"_axe | "she"_axe | "his"_axe | "hers"_axe);
+        gbassert(alternatives(text.cbegin(), text.cend()).position == words(text.cbegin(), text.cend()).position);
+
+        // works inside grammars and with parse_tree
+        std::vector<std::string> found;
+        text = "this is his house, she said";
+        gbassert(parse(*(words >> e_push_back(found)), text).matched);
+        gbassert(found == std::vector<std::string>{ "this", " is his", " house, she" });
+
+        std::vector<size_t> indexes;
+        for(auto& [index, range] : parse_tree(*words, text).data)
+            indexes.push_back(index);
+        gbassert(indexes == std::vector<size_t>{ 2, 2, 1 });
+
+        // forward iterators and the prefilter for a single first byte
+        std::list<char> list{ 'x', 'a', 'a', 'b', 'y' };
+        auto ab = r_find_any(std::vector<std::string>{ "ab", "aab" });
+        gbassert(ab(list.begin(), list.end()).position == std::prev(list.end()));
+        text = "xxaab";
+        gbassert(ab.search(text.cbegin(), text.cend()).data.first == 1);
+
+        // empty pattern matches immediately
+        gbassert(r_find_any({ "a", "" })(text.cbegin(), text.cend()).position == text.cbegin());
+        gbassert(is_nullable(r_find_any({ "a", "" })) && !is_nullable(words));
+
+        // compare with ordered choice on random patterns
+        std::mt19937 gen(39);
+        auto random_string = [&](size_t max_length)
+        {
+            std::string s;
+            auto length = std::uniform_int_distribution<size_t>(0, max_length)(gen);
+            for(size_t i = 0; i < length; ++i)
+                s += "abc"[std::uniform_int_distribution<size_t>(0, 2)(gen)];
+            return s;
+        };
+
+        for(size_t i = 0; i < 1000; ++i)
+        {
+            std::vector<std::string> patterns(1 + std::uniform_int_distribution<size_t>(0, 6)(gen));
+            for(auto& p : patterns)
+                p = random_string(4);
+            auto rule = r_find_any(patterns);
+
+            for(size_t j = 0; j < 10; ++j)
+            {
+                auto input = random_string(20);
+                auto [pattern, pos] = naive_find(patterns, input);
+                auto actual = rule.search(input.cbegin(), input.cend());
+                gbassert(actual.matched == (pattern != size_t(-1)));
+                gbassert(!actual.matched || (actual.data.first == pattern
+                    && actual.data.second.begin() == input.cbegin() + pos
+                    && actual.position == input.cbegin() + pos + patterns[pattern].size()));
+            }
+        }
+
+        // large pattern sets
+        std::vector<std::string> blocklist;
+        for(size_t i = 0; i < 10000; ++i)
+            blocklist.push_back("word" + std::to_string(i * 7919 % 100003));
+        auto blocked = r_find_any(blocklist);
+        text = std::string(100000, ' ') + "word" + std::to_string(7919 * 9999 % 100003) + "!";
+        auto found_word = blocked.search(text.cbegin(), text.cend());
+        gbassert(found_word.matched && found_word.data.first == 9999 && found_word.position == text.cend() - 1);
+    }
+}
@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <string>
+#include <cstring>
+#include <list>
+#include <sstream>
+#include <iterator>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    GB_TEST(axe, test_null_sentinel)
+    {
+        const char* msg = "key=value;id=42";
+        null_sentinel end;
+        gbassert(end != msg && end == msg + std::strlen(msg));
+
+        std::string key, value;
+        unsigned id = 0;
+        auto pair = (+_a >> key) & '=' & (+_a >> value) & ';' & "id=" & (r_udecimal(id)) & _z;
+        auto res = pair(msg, end);
+        gbassert(res.matched && res.position == msg + std::strlen(msg));
+        gbassert(key == "key" && value == "value" && id == 42);
+        gbassert(parse(pair, msg).matched);
+
+        // composite rules
+        gbassert((r_str("key") ^ r_str("=")) (msg, end).matched);
+        gbassert((r_str("key") | r_str("x")) (msg, end).matched);
+        gbassert((r_str("key") || r_str("=")) (msg, end).position == msg + 4);
+        gbassert((r_str("key") > '=')(msg, end).position == msg + 4);
+        gbassert(r_range(std::string("key="))(msg, end).matched);
+        gbassert(!r_range(std::string("key=value;id=42!"))(msg, end).matched);
+        gbassert(r_convert(r_str("KEY"), [](char c) { return char(std::toupper(c)); })(msg, end).matched);
+        gbassert(r_find(r_lit(';'))(msg, end).position == msg + 10);
+        gbassert(r_regex("[a-z]+=\\w+")(msg, end).position == msg + 9);
+        gbassert(r_regex("([a-z]+)=\\1", std::regex::ECMAScript)(msg, end).matched == false);
+        gbassert((*_ & _z)(msg, end).position == msg + std::strlen(msg));
+        gbassert((_ * 100)(msg, end).matched == false);
+
+        gbassert(r_skip(r_str("key=value"), r_lit(' '))(" k e y = value", end).matched);
+        gbassert(r_dfa(+_a & '=')(msg, end).position == msg + 4);
+        gbassert(r_find_any({ "id", "value" })(msg, end).position == msg + 9);
+        gbassert(r_buffered(+(_ - ';') & ';' & "id=" & +_d)(msg, end).position == msg + 15);
+        gbassert(r_many(+_a, ',')("a,bb,ccc", end).matched);
+        gbassert(r_istr("KEY=VALUE")(msg, end).matched);
+        double d = 0;
+        gbassert((r_double(d) & _z)("-1.5e3", end).matched && d == -1.5e3);
+
+                r_rule<const char*, null_sentinel> list;
+        list = _a & ~(',' & list);
+        const char* items = "a,b,c";
+        gbassert(list(items, end).position == items + 5);
+        gbassert(parse(list & _z, items).matched);
+
+        // wide strings
+        const wchar_t* wide = L"abc";
+        gbassert((r_str(L"abc") & _z)(wide, null_sentinel()).matched);
+    }
+
+    GB_TEST(axe, test_contiguous_parse)
+    {
+        auto date = r_udecimal() & '-' & r_udecimal() & '-' & r_udecimal();
+        auto word = +_a;
+        static_assert(detail::is_iterator_independent_rule_v<decltype(word)>);
+        static_assert(detail::is_iterator_independent_rule_v<r_dfa>);
+        static_assert(detail::is_iterator_independent_rule_v<r_find_any>);
+        static_assert(detail::is_iterator_independent_rule_v<decltype(r_regex("a+"))>);
+        static_assert(!detail::is_iterator_independent_rule_v<decltype(date)>);
+        auto action = word >> [](auto, auto) {};
+        static_assert(!detail::is_iterator_independent_rule_v<decltype(action)>);
+        static_assert(!detail::is_iterator_independent_rule_v<r_rule<std::string::iterator>>);
+
+        // positions are mapped back to the caller's iterators
+        std::string text("word 42");
+        const std::string& ctext = text;
+        std::vector<char> chars(text.begin(), text.end());
+        auto res = parse(word, text);
+        gbassert(res.matched && res.position == text.begin() + 4);
+        gbassert(parse(word, ctext).position == ctext.begin() + 4);
+        gbassert(parse(word, chars).position == chars.begin() + 4);
+        gbassert(parse(r_dfa(word & ' '), text.begin(), text.end()).position == text.begin() + 5);
+        gbassert(parse(r_find_any({ "42" }), text).position == text.end());
+        gbassert(parse(r_regex("\\w+ \\d"), chars).position == chars.begin() + 6);
+        std::string empty;
+        gbassert(parse(*_a, empty).position == empty.end());
+        gbassert(!parse(word, empty).matched);
+
+        // r_contiguous runs semantic actions with pointers
+        std::string number;
+        auto digits = r_contiguous(+_d >> [&](const char* i1, const char* i2) { number.assign(i1, i2); });
+        gbassert(parse(_a * 4 & ' ' & digits, text).position == text.end());
+        gbassert(number == "42");
+        std::list<char> list(text.begin(), text.end());
+        auto any = r_contiguous(+_);
+        gbassert(any(list.begin(), list.end()).position == list.end());
+    }
+}
@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+//  Copyright (C) 2011-2022, Gene Bushuyev
+//  
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include <string>
+#include <vector>
+#include <thread>
+#include "../include/axe.h"
+#include <yadro/util/gbtest.h>
+
+using namespace axe;
+using namespace axe::shortcuts;
+
+namespace
+{
+    using namespace gb::yadro::util;
+
+    GB_TEST(axe, test_tape)
+    {
+        using I = std::string::const_iterator;
+        const std::string text("a=1;bb=22;ccc=x;");
+
+        event_tape<I> tape(64);
+
+        auto key = r_tape(tape, r_named(+_a, "key"));
+        auto number = r_tape(tape, r_named(+_d, "number"));
+        auto word = r_tape(tape, +_a, "word");
+        // the first alternative writes key event and fails on non-digit value
+        auto pair = r_tape(tape, (key & '=' & number & ';') | (key & '=' & word & ';'), "pair");
+
+        gbassert(parse_tape(*pair & _z, tape, text).matched);
+        gbassert(tape.size() == 9);
+
+        // tape can be processed in another thread after parsing
+        std::vector<std::string> events;
+        std::thread consumer([&]
+        {
+            for(auto& event : tape)
+                events.push_back(std::string(event.tag) + ':' + get_as<std::string>(make_it_pair(tape, event)));
+        });
+        consumer.join();
+
+        gbassert(events == std::vector<std::string>{
+            "pair:a=1;", "key:a", "number:1",
+            "pair:bb=22;", "key:bb", "number:22",
+            "pair:ccc=x;", "key:ccc", "word:x" });
+
+        // extractor form, offsets are relative to the beginning of text
+        gbassert(parse_tape(*(+_a >> e_tape(tape, "id") | _), tape, text).matched);
+        gbassert(tape.size() == 4);
+        gbassert(tape[3].begin == 14 && tape[3].end == 15);
+        gbassert(make_it_pair(tape[1], text.begin()).size() == 2);
+
+        // failed parsing leaves empty tape
+        gbassert(!parse_tape(+(key & '=' & number & ';') & _z, tape, text).matched);
+        gbassert(tape.empty());
+    }
+}
@@ -28,9 +28,18 @@
 
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <optional>
 #include <vector>
+#include <algorithm>
+#include <cstring>
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_ranges)
+#include <ranges>
+#endif
 #include <yadro/util/gbtest.h>
 #include "../include/axe.h"
 
@@ -152,4 +161,53 @@ Phone: 408-278-7400
 408-278-7400
 )*");
     }
+
+    template<class Txt, class = void>
+    constexpr bool can_match_v = false;
+
+    template<class Txt>
+    constexpr bool can_match_v<Txt, std::void_t<decltype(matches(_d, std::declval<Txt>()))>> = true;
+
+    GB_TEST(axe, test_matches)
+    {
+        auto zips = std::string("94302 Zip Code\n94303-1011 Zip Code\n123456 no zip\n94309");
+        auto zip_rule = _d * 5 & ~('-' & _d * 4) & !_d;
+
+        // matches are found lazily, no container is produced
+        std::vector<std::string> found;
+        for(auto& m : matches(zip_rule, zips))
+            found.push_back(get_as<std::string>(m));
+        gbassert(found == std::vector<std::string>{ "94302", "94303-1011", "23456", "94309" });
+
+        // early stop with standard algorithms, pointers into memory
+        const char* text = "a1 b22 c333 d4444";
+        auto numbers = matches(+_d, text, text + std::strlen(text));
+        auto it = std::find_if(numbers.begin(), numbers.end(), [](auto& m) { return m.size() == 3; });
+        gbassert(it != numbers.end() && it->begin() == text + 8);
+        gbassert(std::distance(numbers.begin(), numbers.end()) == 4);
+
+        // empty matches advance by one element, the same as r_find in a loop
+        std::string abc("abc");
+        auto empty = matches(*_d, abc);
+        gbassert(std::distance(empty.begin(), empty.end()) == 4);
+        auto none = matches(r_char('x'), abc);
+        gbassert(none.begin() == none.end());
+
+        // temporary text is rejected, views are accepted
+        static_assert(can_match_v<std::string&> && can_match_v<std::string_view> && !can_match_v<std::string>);
+        auto view = matches(+_d, std::string_view(zips).substr(0, 20));
+        gbassert(std::distance(view.begin(), view.end()) == 2);
+
+        // literals located by r_find_any
+        std::vector<size_t> offsets;
+        for(auto& m : matches(r_find_any({ "Zip", "Code" }), zips))
+            offsets.push_back(m.begin() - zips.begin());
+        gbassert(offsets == std::vector<size_t>{ 6, 10, 26, 30 });
+
+#if defined(__cpp_lib_ranges)
+        auto zip_matches = matches(zip_rule, zips);
+        auto first_two = zip_matches | std::views::take(2);
+        gbassert(std::ranges::distance(first_two) == 2);
+#endif
+    }
 }
\ No newline at end of file